@@ -277,7 +277,7 @@
 					case CMD_SAVE_SERVER:
 					case CMD_SHALLOW_SAVE_SERVER: {
 						addLogLine(LOGTYPE_EVENT, "saving server");
-						Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::saveGameState, &g_game, (command == CMD_SHALLOW_SAVE_SERVER))));
+						Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::proceduralSave, &g_game, (command == CMD_SHALLOW_SAVE_SERVER))));
 						output->put<char>(AP_MSG_COMMAND_OK);
 						break;
 					}
@@ -55,11 +55,157 @@
 		}
 	#endif
 
+	SlabAllocator::SlabAllocator(const std::string& name, size_t objectSize, size_t slabObjects):
+		m_name(name), m_slabObjects(slabObjects), m_free(NULL) {
+			// keep every slot aligned like malloc would
+			m_slotSize = (std::max(objectSize, sizeof(FreeSlot)) + 15) & ~(size_t)15;
+			m_live = m_allocations = m_fallbacks = m_capacity = m_requestedBytes = 0;
+
+			boost::mutex::scoped_lock lockClass(getRegistryLock());
+			getRegistry().push_back(this);
+	}
+
+	void* SlabAllocator::allocate(size_t size) {
+		if (size > m_slotSize) {
+			// derived classes bigger than the slot, like HouseTile
+			m_fallbacks.fetch_add(1, boost::memory_order_relaxed);
+			return ::operator new(size);
+		}
+
+		Cache& cache = getCache();
+		if (!cache.head) {
+			refill(cache);
+		}
+
+		FreeSlot* slot = cache.head;
+		cache.head = slot->next;
+		--cache.count;
+
+		m_live.fetch_add(1, boost::memory_order_relaxed);
+		m_allocations.fetch_add(1, boost::memory_order_relaxed);
+		m_requestedBytes.fetch_add(size, boost::memory_order_relaxed);
+		return slot;
+	}
+
+	void SlabAllocator::deallocate(void* p, size_t size) {
+		if (!p) {
+			return;
+		}
+
+		if (size > m_slotSize) {
+			::operator delete(p);
+			return;
+		}
+
+		Cache& cache = getCache();
+		FreeSlot* slot = reinterpret_cast<FreeSlot*>(p);
+		slot->next = cache.head;
+		cache.head = slot;
+		if (++cache.count > SLAB_BATCH * 2) {
+			release(cache, SLAB_BATCH);
+		}
+
+		m_live.fetch_sub(1, boost::memory_order_relaxed);
+		m_requestedBytes.fetch_sub(size, boost::memory_order_relaxed);
+	}
+
+	double SlabAllocator::getFragmentation() const {
+		uint64_t reserved = getReservedBytes();
+		if (!reserved) {
+			return 0.;
+		}
+
+		return 1. - (double)getRequestedBytes() / reserved;
+	}
+
+	void SlabAllocator::getAllocators(SlabAllocators& allocators) {
+		boost::mutex::scoped_lock lockClass(getRegistryLock());
+		allocators.assign(getRegistry().begin(), getRegistry().end());
+	}
+
+	SlabAllocator::Cache& SlabAllocator::getCache() {
+		Cache* cache = m_cache.get();
+		if (!cache) {
+			// returned to the shared free list when the thread exits
+			cache = new Cache(this);
+			m_cache.reset(cache);
+		}
+
+		return *cache;
+	}
+
+	void SlabAllocator::refill(Cache& cache) {
+		boost::mutex::scoped_lock lockClass(m_lock);
+		while (cache.count < SLAB_BATCH) {
+			if (!m_free) {
+				grow();
+			}
+
+			FreeSlot* slot = m_free;
+			m_free = slot->next;
+
+			slot->next = cache.head;
+			cache.head = slot;
+			++cache.count;
+		}
+	}
+
+	void SlabAllocator::release(Cache& cache, uint32_t count) {
+		boost::mutex::scoped_lock lockClass(m_lock);
+		for (; count > 0 && cache.head; --count) {
+			FreeSlot* slot = cache.head;
+			cache.head = slot->next;
+			--cache.count;
+
+			slot->next = m_free;
+			m_free = slot;
+		}
+	}
+
+	void SlabAllocator::grow() {
+		char* slab = reinterpret_cast<char*>(std::malloc(m_slotSize * m_slabObjects));
+		if (!slab) {
+			throw std::bad_alloc();
+		}
+
+		m_slabs.push_back(slab);
+		for (size_t i = m_slabObjects; i > 0; --i) {
+			FreeSlot* slot = reinterpret_cast<FreeSlot*>(slab + (i - 1) * m_slotSize);
+			slot->next = m_free;
+			m_free = slot;
+		}
+
+		m_capacity.fetch_add(m_slabObjects, boost::memory_order_relaxed);
+	}
+
+	boost::mutex& SlabAllocator::getRegistryLock() {
+		static boost::mutex* registryLock = new(0) boost::mutex;
+		return *registryLock;
+	}
+
+	SlabAllocators& SlabAllocator::getRegistry() {
+		static SlabAllocators* registry = new(0) SlabAllocators;
+		return *registry;
+	}
+
 	#ifdef __OTSERV_ALLOCATOR_STATS__
 		void allocatorStatsThread(void* a) {
 			while (true) {
 				boost::this_thread::sleep(boost::posix_time::milliseconds(30000));
 				PoolManager::getInstance()->dumpStats();
+
+				SlabAllocators allocators;
+				SlabAllocator::getAllocators(allocators);
+
+				std::ofstream output("data/logs/memory_dump.log", std::ios_base::app);
+				for (SlabAllocators::iterator it = allocators.begin(); it != allocators.end(); ++it) {
+					output << (*it)->getName() << " slot: " << (int32_t)(*it)->getSlotSize() << " live: " << (int64_t)(*it)->getLive();
+					output << " capacity: " << (int64_t)(*it)->getCapacity() << " fallbacks: " << (int64_t)(*it)->getFallbacks();
+					output << " %unused: " << (int32_t)((*it)->getFragmentation() * 100) << std::endl;
+				}
+
+				output << std::endl;
+				output.close();
 			}
 		}
 	#endif
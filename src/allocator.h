@@ -21,6 +21,8 @@
 
 		#include "otsystem.h"
 		#include <boost/pool/pool.hpp>
+		#include <boost/atomic.hpp>
+		#include <boost/thread/tss.hpp>
 
 		#include <memory>
 		#include <cstdlib>
@@ -114,6 +116,8 @@
 							#endif
 
 							tag->poolbytes = it->first;
+							m_allocations.fetch_add(1, boost::memory_order_relaxed);
+							m_pooledBytes.fetch_add(it->first, boost::memory_order_relaxed);
 
 							#ifdef __OTSERV_ALLOCATOR_STATS__
 								poolsStats[it->first]->allocations++;
@@ -133,6 +137,9 @@
 					#endif
 
 					tag->poolbytes = 0;
+					m_allocations.fetch_add(1, boost::memory_order_relaxed);
+					m_largeAllocations.fetch_add(1, boost::memory_order_relaxed);
+
 					poolLock.unlock();
 					return tag + 1;
 				}
@@ -144,7 +151,9 @@
 
 					poolTag* const tag = reinterpret_cast<poolTag*>(deletable) - 1U;
 					poolLock.lock();
+					m_deallocations.fetch_add(1, boost::memory_order_relaxed);
 					if (tag->poolbytes) {
+						m_pooledBytes.fetch_sub(tag->poolbytes, boost::memory_order_relaxed);
 						Pools::iterator it;
 						it = pools.find(tag->poolbytes);
 
@@ -163,6 +172,20 @@
 					poolLock.unlock();
 				}
 
+				// readable from any thread without taking poolLock
+				uint64_t getAllocations() const {
+					return m_allocations.load(boost::memory_order_relaxed);
+				}
+				uint64_t getDeallocations() const {
+					return m_deallocations.load(boost::memory_order_relaxed);
+				}
+				uint64_t getLargeAllocations() const {
+					return m_largeAllocations.load(boost::memory_order_relaxed);
+				}
+				uint64_t getPooledBytes() const {
+					return m_pooledBytes.load(boost::memory_order_relaxed);
+				}
+
 				#ifdef __OTSERV_ALLOCATOR_STATS__
 					void dumpStats() {
 						time_t rawtime;
@@ -211,6 +234,7 @@
 				}
 
 				PoolManager() {
+					m_allocations = m_deallocations = m_largeAllocations = m_pooledBytes = 0;
 					addPool(4 + sizeof(poolTag), 32768);
 					addPool(20 + sizeof(poolTag), 32768);
 					addPool(32 + sizeof(poolTag), 32768);
@@ -239,6 +263,8 @@
 				typedef std::map<size_t, boost::pool<boost::default_user_allocator_malloc_free>*, std::less<size_t>, dummyallocator<std::pair<const size_t, boost::pool<boost::default_user_allocator_malloc_free>*> > > Pools;
 				Pools pools;
 
+				boost::atomic<uint64_t> m_allocations, m_deallocations, m_largeAllocations, m_pooledBytes;
+
 				#ifdef __OTSERV_ALLOCATOR_STATS__
 					struct t_PoolStats {
 						int64_t allocations, deallocations, unused;
@@ -250,5 +276,106 @@
 
 				boost::recursive_mutex poolLock;
 		};
+
+		// objects moved between a thread cache and the shared free list at once
+		#define SLAB_BATCH 32
+
+		class SlabAllocator;
+		typedef std::vector<SlabAllocator*, dummyallocator<SlabAllocator*> > SlabAllocators;
+
+		// Fixed size allocator for a single class: slots are carved out of large
+		// slabs and every thread keeps a small cache of free slots, so the shared
+		// free list is locked only once per SLAB_BATCH allocations. Allocators are
+		// created with new(0) and never destroyed, objects may outlive main().
+		class SlabAllocator {
+			public:
+				SlabAllocator(const std::string& name, size_t objectSize, size_t slabObjects = 1024);
+				virtual ~SlabAllocator() {}
+
+				void* allocate(size_t size);
+				void deallocate(void* p, size_t size);
+
+				const std::string& getName() const {
+					return m_name;
+				}
+				size_t getSlotSize() const {
+					return m_slotSize;
+				}
+
+				// readable from any thread without taking m_lock
+				uint64_t getLive() const {
+					return m_live.load(boost::memory_order_relaxed);
+				}
+				uint64_t getAllocations() const {
+					return m_allocations.load(boost::memory_order_relaxed);
+				}
+				uint64_t getFallbacks() const {
+					return m_fallbacks.load(boost::memory_order_relaxed);
+				}
+				uint64_t getCapacity() const {
+					return m_capacity.load(boost::memory_order_relaxed);
+				}
+				uint64_t getRequestedBytes() const {
+					return m_requestedBytes.load(boost::memory_order_relaxed);
+				}
+				uint64_t getReservedBytes() const {
+					return getCapacity() * m_slotSize;
+				}
+
+				// share of the reserved bytes not used by live objects, both free
+				// slots and the padding of objects smaller than a slot
+				double getFragmentation() const;
+
+				static void getAllocators(SlabAllocators& allocators);
+
+			protected:
+				struct FreeSlot {
+					FreeSlot* next;
+				};
+
+				struct Cache {
+					Cache(SlabAllocator* _owner): owner(_owner), head(NULL), count(0) {}
+					~Cache() {
+						owner->release(*this, count);
+					}
+
+					SlabAllocator* owner;
+					FreeSlot* head;
+					uint32_t count;
+				};
+
+				Cache& getCache();
+				void refill(Cache& cache);
+				void release(Cache& cache, uint32_t count);
+				void grow();
+
+				static boost::mutex& getRegistryLock();
+				static SlabAllocators& getRegistry();
+
+				std::string m_name;
+				size_t m_slotSize, m_slabObjects;
+
+				boost::mutex m_lock;
+				FreeSlot* m_free;
+				std::vector<char*, dummyallocator<char*> > m_slabs;
+
+				boost::thread_specific_ptr<Cache> m_cache;
+				boost::atomic<uint64_t> m_live, m_allocations, m_fallbacks, m_capacity, m_requestedBytes;
+		};
+
+		#define DECLARE_SLAB_ALLOCATOR() \
+			static SlabAllocator& getSlab(); \
+			static void* operator new(size_t size) { \
+				return getSlab().allocate(size); \
+			} \
+			static void operator delete(void* p, size_t size) { \
+				getSlab().deallocate(p, size); \
+			}
+
+		#define DEFINE_SLAB_ALLOCATOR(Class, name, size) \
+			SlabAllocator& Class::getSlab() { \
+				static SlabAllocator* slab = new(0) SlabAllocator(name, size); \
+				return *slab; \
+			}
 	#endif
 #endif
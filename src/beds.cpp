@@ -37,15 +37,10 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream) {
 				return ATTR_READ_ERROR;
 			}
 
-			if (_sleeper) {
-				std::string name;
-				if (IOLoginData::getInstance()->getNameByGuid(_sleeper, name)) {
-					setSpecialDescription(name + " is sleeping there.");
-					Beds::getInstance()->setBedSleeper(this, _sleeper);
-				}
-			}
-
 			sleeper = _sleeper;
+			if (!Beds::getInstance()->isSleepersDeferred()) {
+				loadSleeper();
+			}
 			return ATTR_READ_CONTINUE;
 		}
 
@@ -66,6 +61,14 @@ Attr_ReadValue BedItem::readAttr(AttrTypes_t attr, PropStream& propStream) {
 	return Item::readAttr(attr, propStream);
 }
 
+void BedItem::loadSleeper() {
+	std::string name;
+	if (sleeper && IOLoginData::getInstance()->getNameByGuid(sleeper, name)) {
+		setSpecialDescription(name + " is sleeping there.");
+		Beds::getInstance()->setBedSleeper(this, sleeper);
+	}
+}
+
 bool BedItem::serializeAttr(PropWriteStream& propWriteStream) const {
 	bool ret = Item::serializeAttr(propWriteStream);
 	if (!sleeper) {
@@ -65,6 +65,7 @@
 			void wakeUp();
 
 			BedItem* getNextBedItem();
+			void loadSleeper();
 
 		protected:
 			void updateAppearance(const Player* player);
@@ -90,10 +91,20 @@
 				BedSleepersMap[guid] = bed;
 			}
 
+			// map loader threads only read the sleeper guid, the loading thread resolves it
+			void setSleepersDeferred(bool deferred) {
+				m_sleepersDeferred = deferred;
+			}
+			bool isSleepersDeferred() const {
+				return m_sleepersDeferred;
+			}
+
 		protected:
 			Beds() {
 				BedSleepersMap.clear();
+				m_sleepersDeferred = false;
 			}
 			std::map<uint32_t, BedItem*> BedSleepersMap;
+			bool m_sleepersDeferred;
 	};
 #endif
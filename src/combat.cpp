@@ -125,7 +125,7 @@ bool Combat::getMinMaxValues(Creature* creature, Creature* target, int32_t& min,
 	return true;
 }
 
-void Combat::getCombatArea(const Position& centerPos, const Position& targetPos, const CombatArea* area, std::list<Tile*>& list) {
+void Combat::getCombatArea(const Position& centerPos, const Position& targetPos, const CombatArea* area, CombatTileList& list) {
 	if (area) {
 		area->getList(centerPos, targetPos, list);
 	} else if (targetPos.z < MAP_MAX_LAYERS) {
@@ -217,7 +217,7 @@ ConditionType_t Combat::DamageToConditionType(CombatType_t type) {
 }
 
 ReturnValue Combat::canDoCombat(const Creature* caster, const Tile* tile, bool isAggressive) {
-	if (tile->hasProperty(BLOCKPROJECTILE) || tile->floorChange() || tile->getTeleportItem()) {
+	if (tile->hasFlag(TILESTATE_BLOCKPROJECTILE) || tile->floorChange() || tile->getTeleportItem()) {
 		return RET_NOTENOUGHROOM;
 	}
 
@@ -740,12 +740,10 @@ void Combat::addDistanceEffect(Creature* caster, const Position& fromPos, const
 }
 
 void Combat::CombatFunc(Creature* caster, const Position& pos, const CombatArea* area, const CombatParams& params, COMBATFUNC func, void* data) {
-	std::list<Tile*> tileList;
-	if (caster) {
-		getCombatArea(caster->getPosition(), pos, area, tileList);
-	} else {
-		getCombatArea(pos, pos, area, tileList);
-	}
+	const Position& centerPos = caster ? caster->getPosition() : pos;
+	CombatTileList tileList;
+	tileList.reserve(area ? area->getSize(centerPos, pos) : 1);
+	getCombatArea(centerPos, pos, area, tileList);
 
 	Combat2Var* var = (Combat2Var*)data;
 	if (var && !params.differentAreaDamage) {
@@ -754,7 +752,7 @@ void Combat::CombatFunc(Creature* caster, const Position& pos, const CombatArea*
 
 	uint32_t maxX = 0, maxY = 0, diff;
 	// calculate the max viewable range
-	for (std::list<Tile*>::iterator it = tileList.begin(); it != tileList.end(); ++it) {
+	for (CombatTileList::iterator it = tileList.begin(); it != tileList.end(); ++it) {
 		diff = std::abs((*it)->getPosition().x - pos.x);
 		if (diff > maxX) {
 			maxX = diff;
@@ -766,11 +764,19 @@ void Combat::CombatFunc(Creature* caster, const Position& pos, const CombatArea*
 		}
 	}
 
-	SpectatorVec list;
-	g_game.getSpectators(list, pos, false, true, maxX + Map::maxViewportX, maxX + Map::maxViewportX, maxY + Map::maxViewportY, maxY + Map::maxViewportY);
+	// area hits are gathered and sent to the spectators once the cast is done
+	CombatBatch batch;
+	bool batched = area && g_config.getBool(ConfigManager::BATCH_AREA_COMBAT);
+	if (batched) {
+		g_game.startCombatBatch(batch, pos, maxX, maxY);
+	} else {
+		g_game.getSpectators(batch.spectators, pos, false, true, maxX + Map::maxViewportX, maxX + Map::maxViewportX, maxY + Map::maxViewportY, maxY + Map::maxViewportY);
+	}
+
+	const SpectatorVec& list = batch.spectators;
 
 	Tile* tile = NULL;
-	for (std::list<Tile*>::iterator it = tileList.begin(); it != tileList.end(); ++it) {
+	for (CombatTileList::iterator it = tileList.begin(); it != tileList.end(); ++it) {
 		if (!(tile = (*it)) || canDoCombat(caster, (*it), params.isAggressive) != RET_NOERROR) {
 			continue;
 		}
@@ -806,6 +812,10 @@ void Combat::CombatFunc(Creature* caster, const Position& pos, const CombatArea*
 		}
 		combatTileEffects(list, caster, tile, params);
 	}
+
+	if (batched) {
+		g_game.finishCombatBatch(batch);
+	}
 	postCombatEffects(caster, pos, params);
 }
 
@@ -1097,7 +1107,11 @@ void CombatArea::clear() {
 	for (CombatAreas::iterator it = areas.begin(); it != areas.end(); ++it) {
 		delete it->second;
 	}
+
 	areas.clear();
+	for (int32_t dir = NORTH; dir <= NORTHEAST; ++dir) {
+		offsets[dir].clear();
+	}
 }
 
 CombatArea::CombatArea(const CombatArea& rhs) {
@@ -1105,40 +1119,78 @@ CombatArea::CombatArea(const CombatArea& rhs) {
 	for (CombatAreas::const_iterator it = rhs.areas.begin(); it != rhs.areas.end(); ++it) {
 		areas[it->first] = new MatrixArea(*it->second);
 	}
+
+	for (int32_t dir = NORTH; dir <= NORTHEAST; ++dir) {
+		offsets[dir] = rhs.offsets[dir];
+	}
 }
 
-bool CombatArea::getList(const Position& centerPos, const Position& targetPos, std::list<Tile*>& list) const {
-	Tile* tile = g_game.getTile(targetPos);
-	const MatrixArea* area = getArea(centerPos, targetPos);
-	if (!area) {
+bool CombatArea::getList(const Position& centerPos, const Position& targetPos, CombatTileList& list) const {
+	const AreaOffsets& area = offsets[getDirection(centerPos, targetPos)];
+	if (area.empty()) {
 		return false;
 	}
 
-	uint16_t tmpX = targetPos.x, tmpY = targetPos.y, centerY = 0, centerX = 0;
-	size_t cols = area->getCols(), rows = area->getRows();
-	area->getCenter(centerY, centerX);
+	if (targetPos.z >= MAP_MAX_LAYERS) {
+		return true;
+	}
 
-	tmpX -= centerX;
-	tmpY -= centerY;
-	for (size_t y = 0; y < rows; ++y) {
-		for (size_t x = 0; x < cols; ++x) {
-			if (area->getValue(y, x) != 0) {
-				if (targetPos.z < MAP_MAX_LAYERS && g_game.isSightClear(targetPos, Position(tmpX, tmpY, targetPos.z), true)) {
-					if (!(tile = g_game.getTile(tmpX, tmpY, targetPos.z))) {
-						tile = new StaticTile(tmpX, tmpY, targetPos.z);
-						g_game.setTile(tile);
-					}
-					list.push_back(tile);
-				}
+	// offsets come row by row, so neighbouring cells mostly share a leaf
+	Map* map = g_game.getMap();
+	QTreeLeafNode* leaf = NULL;
+	int32_t leafX = -1, leafY = -1;
+	for (AreaOffsets::const_iterator it = area.begin(); it != area.end(); ++it) {
+		int32_t x = targetPos.x + it->x, y = targetPos.y + it->y;
+		if (x < 0 || x > 0xFFFF || y < 0 || y > 0xFFFF || !g_game.isSightClear(targetPos, Position(x, y, targetPos.z), true)) {
+			continue;
+		}
+
+		if ((x >> FLOOR_BITS) != leafX || (y >> FLOOR_BITS) != leafY) {
+			leaf = map->getLeaf(x, y);
+			leafX = x >> FLOOR_BITS;
+			leafY = y >> FLOOR_BITS;
+		}
+
+		Tile* tile = NULL;
+		if (leaf) {
+			if (Floor* floor = leaf->getFloor(targetPos.z)) {
+				tile = floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
 			}
-			tmpX++;
 		}
-		tmpX -= cols;
-		tmpY++;
+
+		if (!tile) {
+			tile = new StaticTile(x, y, targetPos.z);
+			g_game.setTile(tile);
+			// setting the tile may have created the leaf or floor
+			leafX = leafY = -1;
+		}
+
+		list.push_back(tile);
 	}
 	return true;
 }
 
+void CombatArea::setupOffsets(Direction dir) {
+	AreaOffsets& area = offsets[dir];
+	area.clear();
+
+	CombatAreas::const_iterator it = areas.find(dir);
+	if (it == areas.end()) {
+		return;
+	}
+
+	const MatrixArea* matrix = it->second;
+	uint16_t centerY = 0, centerX = 0;
+	matrix->getCenter(centerY, centerX);
+	for (size_t y = 0; y < matrix->getRows(); ++y) {
+		for (size_t x = 0; x < matrix->getCols(); ++x) {
+			if (matrix->getValue(y, x)) {
+				area.push_back(AreaOffset((int32_t)x - centerX, (int32_t)y - centerY));
+			}
+		}
+	}
+}
+
 void CombatArea::copyArea(const MatrixArea* input, MatrixArea* output, MatrixOperation_t op) const {
 	uint16_t centerY, centerX;
 	input->getCenter(centerY, centerX);
@@ -1252,6 +1304,11 @@ void CombatArea::setupArea(const std::list<uint32_t>& list, uint32_t rows) {
 	MatrixArea* westArea = new MatrixArea(maxOutput, maxOutput);
 	copyArea(area, westArea, MATRIXOPERATION_ROTATE270);
 	areas[WEST] = westArea;
+
+	setupOffsets(NORTH);
+	setupOffsets(SOUTH);
+	setupOffsets(EAST);
+	setupOffsets(WEST);
 }
 
 void CombatArea::setupArea(int32_t length, int32_t spread) {
@@ -1340,6 +1397,10 @@ void CombatArea::setupExtArea(const std::list<uint32_t>& list, uint32_t rows) {
 	copyArea(swArea, seArea, MATRIXOPERATION_MIRROR);
 	areas[SOUTHEAST] = seArea;
 
+	setupOffsets(NORTHWEST);
+	setupOffsets(NORTHEAST);
+	setupOffsets(SOUTHWEST);
+	setupOffsets(SOUTHEAST);
 	hasExtArea = true;
 }
 
@@ -191,6 +191,14 @@
 
 	typedef std::map<Direction, MatrixArea* > CombatAreas;
 
+	struct AreaOffset {
+		AreaOffset(int16_t _x, int16_t _y): x(_x), y(_y) {}
+		int16_t x, y;
+	};
+
+	typedef std::vector<AreaOffset> AreaOffsets;
+	typedef std::vector<Tile*> CombatTileList;
+
 	class CombatArea {
 		public:
 			CombatArea() {
@@ -204,7 +212,10 @@
 
 			ReturnValue doCombat(Creature* attacker, const Position& pos, const Combat& combat) const;
 
-			bool getList(const Position& centerPos, const Position& targetPos, std::list<Tile*>& list) const;
+			bool getList(const Position& centerPos, const Position& targetPos, CombatTileList& list) const;
+			size_t getSize(const Position& centerPos, const Position& targetPos) const {
+				return offsets[getDirection(centerPos, targetPos)].size();
+			}
 
 			void setupArea(const std::list<uint32_t>& list, uint32_t rows);
 			void setupArea(int32_t length, int32_t spread);
@@ -219,7 +230,9 @@
 			MatrixArea* createArea(const std::list<uint32_t>& list, uint32_t rows);
 			void copyArea(const MatrixArea* input, MatrixArea* output, MatrixOperation_t op) const;
 
-			MatrixArea* getArea(const Position& centerPos, const Position& targetPos) const {
+			void setupOffsets(Direction dir);
+
+			Direction getDirection(const Position& centerPos, const Position& targetPos) const {
 				int32_t dx = targetPos.x - centerPos.x, dy = targetPos.y - centerPos.y;
 				Direction dir = NORTH;
 				if (dx < 0) {
@@ -243,15 +256,12 @@
 						dir = SOUTHEAST;
 					}
 				}
-
-				CombatAreas::const_iterator it = areas.find(dir);
-				if (it != areas.end()) {
-					return it->second;
-				}
-				return NULL;
+				return dir;
 			}
 
 			CombatAreas areas;
+			// marked cells of every direction relative to the target, row by row
+			AreaOffsets offsets[NORTHEAST + 1];
 			bool hasExtArea;
 	};
 
@@ -272,7 +282,7 @@
 			static void doCombatDispel(Creature* caster, Creature* target, const CombatParams& params);
 			static void doCombatDispel(Creature* caster, const Position& pos, const CombatArea* area, const CombatParams& params);
 
-			static void getCombatArea(const Position& centerPos, const Position& targetPos, const CombatArea* area, std::list<Tile*>& list);
+			static void getCombatArea(const Position& centerPos, const Position& targetPos, const CombatArea* area, CombatTileList& list);
 
 			static bool isInPvpZone(const Creature* attacker, const Creature* target);
 			static bool isProtected(Player* attacker, Player* target);
@@ -28,6 +28,12 @@
 extern ConfigManager g_config;
 extern Game g_game;
 
+#ifdef __OTSERV_ALLOCATOR__
+	// all conditions share one slab, so a slot has to fit the biggest of them
+	DEFINE_SLAB_ALLOCATOR(Condition, "condition", std::max(std::max(std::max(sizeof(ConditionAttributes), sizeof(ConditionRegeneration)),
+		std::max(sizeof(ConditionDamage), sizeof(ConditionSpeed))), std::max(std::max(sizeof(ConditionSoul), sizeof(ConditionLight)), sizeof(ConditionManaShield))))
+#endif
+
 Condition::Condition(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId):id(_id), subId(_subId), ticks(_ticks), endTime(0), conditionType(_type), buff(_buff) {}
 
 bool Condition::setParam(ConditionParam_t param, int32_t value) {
@@ -135,7 +141,7 @@ bool Condition::serialize(PropWriteStream& propWriteStream) {
 	propWriteStream.addType((int32_t)id);
 
 	propWriteStream.addByte(CONDITIONATTR_TICKS);
-	propWriteStream.addType((int32_t)ticks);
+	propWriteStream.addType((int32_t)getTicks());
 
 	propWriteStream.addByte(CONDITIONATTR_BUFF);
 	propWriteStream.addType((int32_t)buff ? 1 : 0);
@@ -169,7 +175,7 @@ bool Condition::executeCondition(Creature* creature, int32_t interval) {
 		return true;
 	}
 
-	ticks = std::max((int32_t)0, (ticks - interval));
+	// getTicks counts down from endTime, so nothing to decrement here
 	return (endTime >= OTSYS_TIME());
 }
 
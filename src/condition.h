@@ -28,6 +28,10 @@
 
 	#include "fileloader.h"
 
+	#ifdef __OTSERV_ALLOCATOR__
+		#include "allocator.h"
+	#endif
+
 	class Creature;
 	class Player;
 	class PropStream;
@@ -106,6 +110,10 @@
 
 	class Condition {
 		public:
+			#ifdef __OTSERV_ALLOCATOR__
+				DECLARE_SLAB_ALLOCATOR()
+			#endif
+
 			Condition(ConditionId_t _id, ConditionType_t _type, int32_t _ticks, bool _buff, uint32_t _subId);
 			virtual ~Condition() {}
 
@@ -114,6 +122,12 @@
 			virtual void endCondition(Creature*, ConditionEnd_t) {}
 			virtual void addCondition(Creature*, const Condition*) {}
 
+			// whether executeCondition does anything before the condition ends,
+			// the others are only run by their owner once their end time passed
+			virtual bool isPeriodic() const {
+				return conditionType == CONDITION_HUNTING;
+			}
+
 			virtual Icons_t getIcons() const;
 			ConditionId_t getId() const {
 				return id;
@@ -133,6 +147,9 @@
 				return ticks == -1 ? 0 : endTime;
 			}
 			int32_t getTicks() const {
+				if (ticks > 0 && endTime) {
+					return (int32_t)std::max((int64_t)0, endTime - OTSYS_TIME());
+				}
 				return ticks;
 			}
 			void setTicks(int32_t newTicks);
@@ -226,6 +243,9 @@
 
 			virtual void addCondition(Creature* creature, const Condition* addCondition);
 			virtual bool executeCondition(Creature* creature, int32_t interval);
+			virtual bool isPeriodic() const {
+				return true;
+			}
 
 			virtual ConditionRegeneration* clone() const {
 				return new ConditionRegeneration(*this);
@@ -248,6 +268,9 @@
 
 			virtual void addCondition(Creature* creature, const Condition* addCondition);
 			virtual bool executeCondition(Creature* creature, int32_t interval);
+			virtual bool isPeriodic() const {
+				return true;
+			}
 
 			virtual ConditionSoul* clone() const {
 				return new ConditionSoul(*this);
@@ -272,6 +295,9 @@
 
 			virtual bool startCondition(Creature* creature);
 			virtual bool executeCondition(Creature* creature, int32_t interval);
+			virtual bool isPeriodic() const {
+				return true;
+			}
 			virtual void addCondition(Creature* creature, const Condition* condition);
 
 			virtual Icons_t getIcons() const;
@@ -373,6 +399,9 @@
 
 			virtual bool startCondition(Creature* creature);
 			virtual bool executeCondition(Creature* creature, int32_t interval);
+			virtual bool isPeriodic() const {
+				return true;
+			}
 			virtual void endCondition(Creature* creature, ConditionEnd_t reason);
 			virtual void addCondition(Creature* creature, const Condition* addCondition);
 
@@ -86,6 +86,7 @@ bool ConfigManager::load() {
 			m_confNumber[STATUS_PORT] = getGlobalNumber("statusPort", 7171);
 		}
 
+		m_confNumber[HTTP_PORT] = getGlobalNumber("httpPort", 0);
 		if (m_confString[RUNFILE] == "") {
 			m_confString[RUNFILE] = getGlobalString("runFile", "");
 		}
@@ -117,7 +118,6 @@ bool ConfigManager::load() {
 		m_confString[HOUSE_RENT_PERIOD] = getGlobalString("houseRentPeriod", "monthly");
 		m_confNumber[WORLD_ID] = getGlobalNumber("worldId", 0);
 		m_confBool[RANDOMIZE_TILES] = getGlobalBool("randomizeTiles", true);
-		m_confBool[STORE_TRASH] = getGlobalBool("storeTrash", true);
 		m_confBool[EXPERIENCE_STAGES] = getGlobalBool("experienceStages", false);
 		m_confString[DEFAULT_PRIORITY] = getGlobalString("defaultPriority", "high");
 		m_confBool[GUILD_HALLS] = getGlobalBool("guildHalls", false);
@@ -326,6 +326,7 @@ bool ConfigManager::load() {
 	m_confString[ADMIN_ENCRYPTION] = getGlobalString("adminEncryption", "");
 	m_confString[ADMIN_ENCRYPTION_DATA] = getGlobalString("adminEncryptionData", "");
 	m_confBool[ADDONS_PREMIUM] = getGlobalBool("addonsOnlyPremium", true);
+	m_confBool[BATCH_AREA_COMBAT] = getGlobalBool("batchAreaCombat", true);
 	m_confBool[UNIFIED_SPELLS] = getGlobalBool("unifiedSpells", true);
 
 	#ifdef __WAR_SYSTEM__
@@ -348,10 +349,15 @@ bool ConfigManager::load() {
 	m_confBool[USE_INFIGHT_CHECK_ON_BED] = getGlobalBool("useInfightCheckOnBed", false);
 	m_confBool[HIDE_SPELL_WORDS] = getGlobalBool("hideSpellWords", false);
 	m_confBool[PLAYER_CAN_BLOCK_MONSTER_SPAWN] = getGlobalBool("playerCanBlockMonsterSpawn", true);
+	m_confNumber[SPAWN_HIBERNATION_RANGE] = getGlobalNumber("spawnHibernationRange", 32);
 	m_confNumber[DEPOT_DEFAULT_LIMIT] = getGlobalNumber("depotDefaultLimit", 1000);
 	m_confNumber[DEPOT_DEFAULT_PREMIUM_LIMIT] = getGlobalNumber("depotDefaultPremiumLimit", 2000);
 	m_confBool[REMOVE_SWORDSICON_IN_PROTECTION_ZONE] = getGlobalBool("removeSwordsIconInProtectionZone", false);
 	m_confBool[SOUL_REGENERATION_WORK_ANY_ZONE] = getGlobalBool("soulRegenerationWorkAnyZone", false);
+	m_confNumber[DISPATCHER_TASK_BUDGET] = getGlobalNumber("dispatcherTaskBudget", 50);
+	m_confNumber[STATUS_CACHE_INTERVAL] = getGlobalNumber("statusCacheInterval", 5000);
+	m_confNumber[MAP_LOADER_THREADS] = getGlobalNumber("mapLoaderThreads", 0);
+	m_confNumber[MAINTENANCE_TICK_BUDGET] = getGlobalNumber("maintenanceTickBudget", 5);
 
 	m_loaded = true;
 	return true;
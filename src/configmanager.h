@@ -182,6 +182,12 @@
 				MAX_CHARACTERS_PER_ACCOUNT,
 				DEPOT_DEFAULT_LIMIT,
 				DEPOT_DEFAULT_PREMIUM_LIMIT,
+				HTTP_PORT,
+				DISPATCHER_TASK_BUDGET,
+				STATUS_CACHE_INTERVAL,
+				MAP_LOADER_THREADS,
+				MAINTENANCE_TICK_BUDGET,
+				SPAWN_HIBERNATION_RANGE,
 				LAST_NUMBER_CONFIG /* this must be the last one */
 			};
 
@@ -259,7 +265,6 @@
 				STOP_ATTACK_AT_EXIT,
 				DISABLE_OUTFITS_PRIVILEGED,
 				OPTIMIZE_DATABASE,
-				STORE_TRASH,
 				HOUSE_STORAGE,
 				TRUNCATE_LOG,
 				TRACER_BOX,
@@ -288,6 +293,7 @@
 				ADMIN_LOCALHOST_ONLY,
 				ADMIN_REQUIRE_LOGIN,
 				ADDONS_PREMIUM,
+				BATCH_AREA_COMBAT,
 
 				#ifdef __WAR_SYSTEM__
 					OPTIONAL_WAR_ATTACK_ALLY,
@@ -26,6 +26,7 @@
 
 #include "outputmessage.h"
 #include "scheduler.h"
+#include "metrics.h"
 
 #include "server.h"
 #include "configmanager.h"
@@ -48,6 +49,7 @@ Connection_ptr ConnectionManager::createConnection(boost::asio::ip::tcp::socket*
 	Connection_ptr connection = boost::shared_ptr<Connection>(new Connection(socket, io_service, servicer));
 
 	m_connections.push_back(connection);
+	Metrics::getInstance()->add(METRIC_CONNECTIONS);
 	return connection;
 }
 
@@ -61,6 +63,7 @@ void ConnectionManager::releaseConnection(Connection_ptr connection) {
 	std::list<Connection_ptr>::iterator it = std::find(m_connections.begin(), m_connections.end(), connection);
 	if (it != m_connections.end()) {
 		m_connections.erase(it);
+		Metrics::getInstance()->add(METRIC_CONNECTIONS, -1);
 	} else {
 		std::clog << "[Error - ConnectionManager::releaseConnection] Connection not found" << std::endl;
 	}
@@ -79,7 +82,9 @@ void ConnectionManager::shutdown() {
 			(*it)->m_socket->close(error);
 		} catch(std::exception&) {}
 	}
+
 	m_connections.clear();
+	Metrics::getInstance()->set(METRIC_CONNECTIONS, 0);
 }
 
 void Connection::close() {
@@ -292,8 +297,13 @@ void Connection::accept() {
 		m_readTimer.expires_from_now(boost::posix_time::seconds(Connection::readTimeout));
 		m_readTimer.async_wait(boost::bind(&Connection::handleReadTimeout, boost::weak_ptr<Connection>(shared_from_this()), boost::asio::placeholders::error));
 
-		// Read size of the first packet
-		boost::asio::async_read(getHandle(), boost::asio::buffer(m_msg.buffer(), NETWORK_HEADER_SIZE), boost::bind(&Connection::parseHeader, shared_from_this(), boost::asio::placeholders::error));
+		if (m_protocol && m_protocol->m_rawInput) {
+			// Read whatever is available, there is no header
+			getHandle().async_read_some(boost::asio::buffer(m_msg.buffer(), NETWORK_MAX_SIZE - 16), boost::bind(&Connection::parseRaw, shared_from_this(), boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+		} else {
+			// Read size of the first packet
+			boost::asio::async_read(getHandle(), boost::asio::buffer(m_msg.buffer(), NETWORK_HEADER_SIZE), boost::bind(&Connection::parseHeader, shared_from_this(), boost::asio::placeholders::error));
+		}
 	} catch(std::exception& e) {
 		if (m_logError) {
 			LOG_MESSAGE(LOGTYPE_ERROR, e.what(), "NETWORK");
@@ -351,6 +361,7 @@ void Connection::parsePacket(const boost::system::error_code& error) {
 	}
 
 	--m_pendingRead;
+	uint32_t received = m_msg.size();
 	uint32_t length = m_msg.size() - m_msg.position() - 4, checksumReceived = m_msg.get<uint32_t>(true), checksum = 0;
 	if (length > 0) {
 		checksum = adlerChecksum((uint8_t*)(m_msg.buffer() + m_msg.position() + 4), length);
@@ -382,6 +393,10 @@ void Connection::parsePacket(const boost::system::error_code& error) {
 		m_protocol->onRecvMessage(m_msg); // Send the packet to the current protocol
 	}
 
+	if (m_protocol) {
+		Metrics::getInstance()->addTraffic(m_protocol->getMetricsIndex(), received, 0);
+	}
+
 	try {
 		++m_pendingRead;
 		m_readTimer.expires_from_now(boost::posix_time::seconds(Connection::readTimeout));
@@ -399,6 +414,41 @@ void Connection::parsePacket(const boost::system::error_code& error) {
 	m_connectionLock.unlock();
 }
 
+void Connection::parseRaw(const boost::system::error_code& error, size_t bytes) {
+	m_connectionLock.lock();
+	m_readTimer.cancel();
+	if (error) {
+		handleReadError(error);
+	}
+
+	if (m_connectionState != CONNECTION_STATE_OPEN || m_readError) {
+		close();
+		m_connectionLock.unlock();
+		return;
+	}
+
+	--m_pendingRead;
+	m_msg.setSize(bytes);
+	m_msg.setPosition(0);
+
+	Metrics::getInstance()->addTraffic(m_protocol->getMetricsIndex(), bytes, 0);
+	if (!m_receivedFirst) {
+		m_receivedFirst = true;
+		m_protocol->onRecvFirstMessage(m_msg);
+	} else {
+		m_protocol->onRecvMessage(m_msg);
+	}
+
+	if (m_connectionState != CONNECTION_STATE_OPEN) {
+		// the protocol disconnected, nothing more to read
+		m_connectionLock.unlock();
+		return;
+	}
+
+	accept();
+	m_connectionLock.unlock();
+}
+
 bool Connection::send(OutputMessage_ptr msg) {
 	#ifdef __DEBUG_NET_DETAIL__
 		std::clog << "Connection::send init" << std::endl;
@@ -442,6 +492,7 @@ void Connection::internalSend(OutputMessage_ptr msg) {
 		m_writeTimer.expires_from_now(boost::posix_time::seconds(Connection::writeTimeout));
 		m_writeTimer.async_wait(boost::bind(&Connection::handleWriteTimeout, boost::weak_ptr<Connection>(shared_from_this()), boost::asio::placeholders::error));
 
+		Metrics::getInstance()->addTraffic(msg->getProtocol() ? msg->getProtocol()->getMetricsIndex() : 0, 0, msg->size());
 		boost::asio::async_write(getHandle(), boost::asio::buffer(msg->getOutputBuffer(), msg->size()), boost::bind(&Connection::onWrite, shared_from_this(), msg, boost::asio::placeholders::error));
 	} catch(std::exception& e) {
 		if (m_logError) {
@@ -486,6 +537,9 @@ void Connection::onWrite(OutputMessage_ptr msg, const boost::system::error_code&
 	}
 
 	--m_pendingWrite;
+	if (!m_pendingWrite && m_protocol) {
+		m_protocol->onSendComplete();
+	}
 	m_connectionLock.unlock();
 }
 
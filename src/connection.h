@@ -141,6 +141,7 @@
 		private:
 			void parseHeader(const boost::system::error_code& error);
 			void parsePacket(const boost::system::error_code& error);
+			void parseRaw(const boost::system::error_code& error, size_t bytes);
 
 			void onWrite(OutputMessage_ptr msg, const boost::system::error_code& error);
 			void onStop();
@@ -25,6 +25,10 @@
 
 extern Game g_game;
 
+#ifdef __OTSERV_ALLOCATOR__
+	DEFINE_SLAB_ALLOCATOR(Container, "container", sizeof(Container))
+#endif
+
 Container::Container(uint16_t type):
 	Item(type) {
 		maxSize = items[type].maxItems;
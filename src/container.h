@@ -54,6 +54,10 @@
 
 	class Container : public Item, public Cylinder {
 		public:
+			#ifdef __OTSERV_ALLOCATOR__
+				DECLARE_SLAB_ALLOCATOR()
+			#endif
+
 			Container(uint16_t type);
 			virtual ~Container();
 			virtual Item* clone() const;
@@ -44,6 +44,9 @@ extern CreatureEvents* g_creatureEvents;
 
 Creature::Creature() {
 	id = 0;
+	eventsMask = 0;
+	conditionsMask = periodicConditions = 0;
+	conditionsExpiry = 0;
 	_tile = NULL;
 	direction = SOUTH;
 	master = NULL;
@@ -102,6 +105,7 @@ Creature::~Creature() {
 	summons.clear();
 	conditions.clear();
 	eventsList.clear();
+	eventsMask = 0;
 }
 
 bool Creature::canSee(const Position& myPos, const Position& pos, uint32_t viewRangeX, uint32_t viewRangeY) {
@@ -1272,11 +1276,15 @@ bool Creature::addCondition(Condition* condition) {
 	if (Condition* previous = getCondition(condition->getType(), condition->getId(), condition->getSubId())) {
 		previous->addCondition(this, condition);
 		delete condition;
+
+		updateConditions();
 		return true;
 	}
 
 	if (condition->startCondition(this)) {
 		conditions.push_back(condition);
+		updateConditions();
+
 		onAddCondition(condition->getType(), hadCondition);
 		return true;
 	}
@@ -1311,6 +1319,8 @@ void Creature::removeCondition(ConditionType_t type) {
 		onEndCondition(condition->getType());
 		delete condition;
 	}
+
+	updateConditions();
 }
 
 void Creature::removeCondition(ConditionType_t type, ConditionId_t id) {
@@ -1327,6 +1337,8 @@ void Creature::removeCondition(ConditionType_t type, ConditionId_t id) {
 		onEndCondition(condition->getType());
 		delete condition;
 	}
+
+	updateConditions();
 }
 
 void Creature::removeCondition(Condition* condition) {
@@ -1338,6 +1350,7 @@ void Creature::removeCondition(Condition* condition) {
 		condition->endCondition(this, CONDITIONEND_ABORT);
 		onEndCondition(condition->getType());
 		delete condition;
+		updateConditions();
 	}
 }
 
@@ -1364,9 +1377,15 @@ void Creature::removeConditions(ConditionEnd_t reason, bool onlyPersistent) {
 		onEndCondition(condition->getType());
 		delete condition;
 	}
+
+	updateConditions();
 }
 
 Condition* Creature::getCondition(ConditionType_t type, ConditionId_t id, uint32_t subId) const {
+	if (!(conditionsMask & type)) {
+		return NULL;
+	}
+
 	for (ConditionList::const_iterator it = conditions.begin(); it != conditions.end(); ++it) {
 		if ((*it)->getType() == type && (*it)->getId() == id && (*it)->getSubId() == subId) {
 			return *it;
@@ -1376,7 +1395,18 @@ Condition* Creature::getCondition(ConditionType_t type, ConditionId_t id, uint32
 }
 
 void Creature::executeConditions(uint32_t interval) {
+	int64_t now = OTSYS_TIME();
+	if (!periodicConditions && (!conditionsExpiry || conditionsExpiry >= now)) {
+		return;
+	}
+
 	for (ConditionList::iterator it = conditions.begin(); it != conditions.end();) {
+		// conditions that do nothing until they end are skipped while they last
+		if (!(*it)->isPeriodic() && ((*it)->getTicks() == -1 || (*it)->getEndTime() >= now)) {
+			++it;
+			continue;
+		}
+
 		if ((*it)->executeCondition(this, interval)) {
 			++it;
 			continue;
@@ -1389,10 +1419,12 @@ void Creature::executeConditions(uint32_t interval) {
 		onEndCondition(condition->getType());
 		delete condition;
 	}
+
+	updateConditions();
 }
 
 bool Creature::hasCondition(ConditionType_t type, int32_t subId, bool checkTime) const {
-	if (isSuppress(type)) {
+	if (!(conditionsMask & type) || isSuppress(type)) {
 		return false;
 	}
 
@@ -1408,6 +1440,23 @@ bool Creature::hasCondition(ConditionType_t type, int32_t subId, bool checkTime)
 	return false;
 }
 
+void Creature::updateConditions() {
+	conditionsMask = periodicConditions = 0;
+	conditionsExpiry = 0;
+	for (ConditionList::const_iterator it = conditions.begin(); it != conditions.end(); ++it) {
+		conditionsMask |= (*it)->getType();
+		if ((*it)->isPeriodic()) {
+			++periodicConditions;
+		} else if ((*it)->getTicks() != -1) {
+			// an end time of 0 has already passed, unlike an expiry of 0
+			int64_t endTime = std::max((int64_t)1, (*it)->getEndTime());
+			if (!conditionsExpiry || endTime < conditionsExpiry) {
+				conditionsExpiry = endTime;
+			}
+		}
+	}
+}
+
 bool Creature::isImmune(CombatType_t type) const {
 	return ((getDamageImmunities() & (uint32_t)type) == (uint32_t)type);
 }
@@ -1474,13 +1523,20 @@ bool Creature::registerCreatureEvent(const std::string& name) {
 		return false;
 	}
 
+	CreatureEventList::iterator pos = eventsList.end();
 	for (CreatureEventList::iterator it = eventsList.begin(); it != eventsList.end(); ++it) {
 		if ((*it) == event) { // do not allow registration of same event more than once
 			return false;
 		}
+
+		if (pos == eventsList.end() && (*it)->getEventType() > event->getEventType()) {
+			pos = it;
+		}
 	}
 
-	eventsList.push_back(event);
+	// keep the order of registration within the type
+	eventsList.insert(pos, event);
+	eventsMask |= (uint32_t)1 << event->getEventType();
 	return true;
 }
 
@@ -1496,6 +1552,13 @@ bool Creature::unregisterCreatureEvent(const std::string& name) {
 		}
 
 		eventsList.erase(it);
+		eventsMask &= ~((uint32_t)1 << event->getEventType());
+		for (it = eventsList.begin(); it != eventsList.end(); ++it) {
+			if ((*it)->getEventType() == event->getEventType()) {
+				eventsMask |= (uint32_t)1 << event->getEventType();
+				break;
+			}
+		}
 		return true; // we shouldn't have a duplicate
 	}
 	return false;
@@ -1503,7 +1566,16 @@ bool Creature::unregisterCreatureEvent(const std::string& name) {
 
 CreatureEventList Creature::getCreatureEvents(CreatureEventType_t type) {
 	CreatureEventList retList;
+	if (!hasCreatureEvent(type)) {
+		return retList;
+	}
+
+	// the events of one type sit next to each other
 	for (CreatureEventList::iterator it = eventsList.begin(); it != eventsList.end(); ++it) {
+		if ((*it)->getEventType() > type) {
+			break;
+		}
+
 		if ((*it)->getEventType() == type && (*it)->isLoaded()) {
 			retList.push_back(*it);
 		}
@@ -627,6 +627,9 @@
 			bool registerCreatureEvent(const std::string& name);
 			bool unregisterCreatureEvent(const std::string& name);
 			CreatureEventList getCreatureEvents(CreatureEventType_t type);
+			bool hasCreatureEvent(CreatureEventType_t type) const {
+				return (eventsMask & ((uint32_t)1 << type));
+			}
 
 			virtual void setParent(Cylinder* cylinder) {
 				_tile = dynamic_cast<Tile*>(cylinder);
@@ -693,6 +696,13 @@
 			GuildEmblems_t guildEmblem;
 			Direction direction;
 			ConditionList conditions;
+			// conditionsMask has the type bit of every condition in the list set
+			// (and may keep stale ones until the next update), periodicConditions
+			// counts those that run every think and conditionsExpiry is the first
+			// end time among the rest, 0 when none of them expires
+			uint32_t conditionsMask, periodicConditions;
+			int64_t conditionsExpiry;
+			void updateConditions();
 			LightInfo internalLight;
 
 			// summon variables
@@ -728,7 +738,10 @@
 			CountMap damageMap;
 			CountMap healMap;
 
+			// registered events kept grouped by type, eventsMask has a bit set
+			// for every type with at least one of them
 			CreatureEventList eventsList;
+			uint32_t eventsMask;
 			uint32_t blockCount, blockTicks, lastHitCreature;
 			CombatType_t lastDamageSource;
 
@@ -64,6 +64,8 @@
 			DBPARAM_MULTIINSERT = 1
 		};
 
+		typedef std::vector<std::string> DBStatementList;
+
 		class _Database {
 			public:
 				/**
@@ -105,6 +107,22 @@
 					m_use = OTSYS_TIME();
 				}
 
+				/**
+				* Statement recording.
+				*
+				* While a list is set query() appends statements to it instead of executing them, transactions are skipped.
+				*
+				* @param DBStatementList* list to record into, NULL stops recording
+				* @note
+				*	The database has to stay locked (DBQuery) until recording stops, so other threads are not recorded.
+				*/
+				void setRecorder(DBStatementList* recorder) {
+					m_recorder = recorder;
+				}
+				bool isRecording() const {
+					return m_recorder != NULL;
+				}
+
 			protected:
 				/**
 				* Transaction related methods.
@@ -210,13 +228,24 @@
 			protected:
 				_Database() {
 					m_connected = false;
+					m_recorder = NULL;
 				}
 				DATABASE_VIRTUAL ~_Database() {}
 
 				DBResult* verifyResult(DBResult* result);
 
+				bool record(const std::string& query) {
+					if (!m_recorder) {
+						return false;
+					}
+
+					m_recorder->push_back(query);
+					return true;
+				}
+
 				bool m_connected;
 				int64_t m_use;
+				DBStatementList* m_recorder;
 
 			private:
 				static Database* _instance;
@@ -279,6 +308,7 @@
 		*/
 		class DBQuery : public std::stringstream {
 			friend class _Database;
+			friend class DBTransaction;
 			public:
 				DBQuery() {
 					databaseLock.lock();
@@ -358,23 +388,52 @@
 				}
 
 				virtual ~DBTransaction() {
+					if (m_state == STATE_RECORD) {
+						return;
+					}
+
 					if (m_state == STATE_START) {
 						m_database->rollback();
+						DBQuery::databaseLock.unlock();
 					}
 				}
 
+				// the connection is shared with the house writer thread, so it stays
+				// locked from begin until commit or rollback
 				bool begin() {
+					if (m_state == STATE_START || m_state == STATE_RECORD) {
+						return false;
+					}
+
+					if (m_database->isRecording()) {
+						m_state = STATE_RECORD; // the statements are replayed in a transaction of their own
+						return true;
+					}
+
+					DBQuery::databaseLock.lock();
+					if (!m_database->beginTransaction()) {
+						DBQuery::databaseLock.unlock();
+						return false;
+					}
+
 					m_state = STATE_START;
-					return m_database->beginTransaction();
+					return true;
 				}
 
 				bool commit() {
+					if (m_state == STATE_RECORD) {
+						m_state = STEATE_COMMIT;
+						return true;
+					}
+
 					if (m_state != STATE_START) {
 						return false;
 					}
 
 					m_state = STEATE_COMMIT;
-					return m_database->commit();
+					bool ret = m_database->commit();
+					DBQuery::databaseLock.unlock();
+					return ret;
 				}
 
 			private:
@@ -382,6 +441,7 @@
 				enum TransactionStates_t {
 					STATE_NO_START,
 					STATE_START,
+					STATE_RECORD,
 					STEATE_COMMIT
 				} m_state;
 		};
@@ -24,6 +24,7 @@
 
 #include "scheduler.h"
 #include "configmanager.h"
+#include "metrics.h"
 
 extern ConfigManager g_config;
 
@@ -125,6 +126,11 @@ bool DatabaseMySQL::commit() {
 }
 
 bool DatabaseMySQL::query(const std::string &query) {
+	if (record(query)) {
+		return true;
+	}
+
+	HistogramTimer timer(Metrics::getInstance()->getHistogram(METRIC_HISTOGRAM_DATABASE_QUERY));
 	if (!m_connected) {
 		return false;
 	}
@@ -151,6 +157,7 @@ bool DatabaseMySQL::query(const std::string &query) {
 }
 
 DBResult* DatabaseMySQL::storeQuery(const std::string &query) {
+	HistogramTimer timer(Metrics::getInstance()->getHistogram(METRIC_HISTOGRAM_DATABASE_QUERY));
 	if (!m_connected) {
 		return NULL;
 	}
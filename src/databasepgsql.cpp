@@ -22,6 +22,7 @@
 #include "databasepgsql.h"
 
 #include "configmanager.h"
+#include "metrics.h"
 extern ConfigManager g_config;
 
 DatabasePgSQL::DatabasePgSQL() {
@@ -49,6 +50,11 @@ bool DatabasePgSQL::getParam(DBParam_t param) {
 }
 
 bool DatabasePgSQL::query(const std::string& query) {
+	if (record(query)) {
+		return true;
+	}
+
+	HistogramTimer timer(Metrics::getInstance()->getHistogram(METRIC_HISTOGRAM_DATABASE_QUERY));
 	if (!m_connected) {
 		return false;
 	}
@@ -68,6 +74,7 @@ bool DatabasePgSQL::query(const std::string& query) {
 }
 
 DBResult* DatabasePgSQL::storeQuery(const std::string& query) {
+	HistogramTimer timer(Metrics::getInstance()->getHistogram(METRIC_HISTOGRAM_DATABASE_QUERY));
 	if (!m_connected) {
 		return NULL;
 	}
@@ -24,6 +24,7 @@
 
 #include "tools.h"
 #include "configmanager.h"
+#include "metrics.h"
 
 extern ConfigManager g_config;
 
@@ -84,6 +85,11 @@ std::string DatabaseSQLite::_parse(const std::string& s) {
 }
 
 bool DatabaseSQLite::query(const std::string& query) {
+	if (record(query)) {
+		return true;
+	}
+
+	HistogramTimer timer(Metrics::getInstance()->getHistogram(METRIC_HISTOGRAM_DATABASE_QUERY));
 	boost::recursive_mutex::scoped_lock lockClass(sqliteLock);
 	if (!m_connected) {
 		return false;
@@ -118,6 +124,7 @@ bool DatabaseSQLite::query(const std::string& query) {
 }
 
 DBResult* DatabaseSQLite::storeQuery(const std::string& query) {
+	HistogramTimer timer(Metrics::getInstance()->getHistogram(METRIC_HISTOGRAM_DATABASE_QUERY));
 	boost::recursive_mutex::scoped_lock lockClass(sqliteLock);
 	if (!m_connected) {
 		return NULL;
@@ -0,0 +1,134 @@
+/*
+* OpenTibia - an opensource roleplaying game.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "otpch.h"
+#include "decay.h"
+
+#include "item.h"
+
+DecayWheel::DecayWheel(uint32_t resolution):
+	m_resolution(resolution), m_tick(OTSYS_TIME() / resolution), m_size(0) {}
+
+void DecayWheel::add(Item* item, int64_t expiry) {
+	if (item->decayEntry) {
+		update(item, expiry);
+		return;
+	}
+
+	DecayEntry* entry = new DecayEntry();
+	entry->item = item;
+	entry->expiry = expiry;
+
+	// the current tick was already handled, round up to the next one at least
+	entry->tick = std::max(m_tick + 1, (uint64_t)((expiry + m_resolution - 1) / m_resolution));
+	item->decayEntry = entry;
+
+	insert(entry);
+	++m_size;
+}
+
+void DecayWheel::update(Item* item, int64_t expiry) {
+	DecayEntry* entry = item->decayEntry;
+	if (!entry) {
+		add(item, expiry);
+		return;
+	}
+
+	entry->unlink();
+	entry->expiry = expiry;
+	entry->tick = std::max(m_tick + 1, (uint64_t)((expiry + m_resolution - 1) / m_resolution));
+	insert(entry);
+}
+
+void DecayWheel::remove(Item* item) {
+	DecayEntry* entry = item->decayEntry;
+	if (!entry) {
+		return;
+	}
+
+	entry->unlink();
+	item->decayEntry = NULL;
+
+	delete entry;
+	--m_size;
+}
+
+void DecayWheel::advance(int64_t now, std::vector<Item*>& expired) {
+	uint64_t target = now / m_resolution;
+	while (m_tick < target) {
+		++m_tick;
+		if (!(m_tick & DECAY_WHEEL_MASK)) {
+			// the first level wrapped, pull the next slots of the upper levels down
+			int32_t level = 1;
+			for (; level < DECAY_WHEEL_LEVELS; ++level) {
+				uint32_t index = (m_tick >> (DECAY_WHEEL_BITS * level)) & DECAY_WHEEL_MASK;
+				cascade(m_slots[level][index]);
+				if (index) {
+					break;
+				}
+			}
+
+			if (level == DECAY_WHEEL_LEVELS) {
+				cascade(m_overflow);
+			}
+		}
+
+		DecayEntry& head = m_slots[0][m_tick & DECAY_WHEEL_MASK];
+		while (head.next != &head) {
+			DecayEntry* entry = head.next;
+			entry->unlink();
+
+			expired.push_back(entry->item);
+			entry->item->decayEntry = NULL;
+
+			delete entry;
+			--m_size;
+		}
+	}
+}
+
+void DecayWheel::insert(DecayEntry* entry) {
+	uint64_t tick = std::max(entry->tick, m_tick), delta = tick - m_tick;
+	for (int32_t level = 0; level < DECAY_WHEEL_LEVELS; ++level) {
+		if (delta < ((uint64_t)1 << (DECAY_WHEEL_BITS * (level + 1)))) {
+			entry->link(&m_slots[level][(tick >> (DECAY_WHEEL_BITS * level)) & DECAY_WHEEL_MASK]);
+			return;
+		}
+	}
+
+	entry->link(&m_overflow);
+}
+
+void DecayWheel::cascade(DecayEntry& head) {
+	DecayEntry list;
+	if (head.next == &head) {
+		return;
+	}
+
+	// move the whole slot aside first, entries may land in the very same slot again
+	list.next = head.next;
+	list.prev = head.prev;
+	list.next->prev = &list;
+	list.prev->next = &list;
+	head.prev = head.next = &head;
+
+	while (list.next != &list) {
+		DecayEntry* entry = list.next;
+		entry->unlink();
+		insert(entry);
+	}
+}
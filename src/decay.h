@@ -0,0 +1,83 @@
+/*
+* OpenTibia - an opensource roleplaying game.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __DECAY__
+	#define __DECAY__
+
+	#include "otsystem.h"
+
+	#define DECAY_WHEEL_BITS 6
+	#define DECAY_WHEEL_SLOTS (1 << DECAY_WHEEL_BITS)
+	#define DECAY_WHEEL_MASK (DECAY_WHEEL_SLOTS - 1)
+	#define DECAY_WHEEL_LEVELS 4
+
+	class Item;
+
+	// the handle an item keeps while it is scheduled, slots are circular lists so unlinking needs no lookup
+	struct DecayEntry {
+		DecayEntry(): item(NULL), expiry(0), tick(0), prev(this), next(this) {}
+
+		void link(DecayEntry* head) {
+			prev = head->prev;
+			next = head;
+			head->prev->next = this;
+			head->prev = this;
+		}
+		void unlink() {
+			prev->next = next;
+			next->prev = prev;
+			prev = next = this;
+		}
+
+		Item* item;
+		int64_t expiry;
+		uint64_t tick;
+		DecayEntry* prev;
+		DecayEntry* next;
+	};
+
+	// Hierarchical timing wheel: the first level has one slot per tick, every
+	// further level covers DECAY_WHEEL_SLOTS slots of the one below and is
+	// cascaded down when the lower level wraps around.
+	class DecayWheel {
+		public:
+			DecayWheel(uint32_t resolution);
+			virtual ~DecayWheel() {}
+
+			void add(Item* item, int64_t expiry);
+			void update(Item* item, int64_t expiry);
+			void remove(Item* item);
+
+			// detaches every item that expired up to now
+			void advance(int64_t now, std::vector<Item*>& expired);
+
+			size_t size() const {
+				return m_size;
+			}
+
+		protected:
+			void insert(DecayEntry* entry);
+			void cascade(DecayEntry& head);
+
+			uint32_t m_resolution;
+			uint64_t m_tick;
+			size_t m_size;
+
+			DecayEntry m_slots[DECAY_WHEEL_LEVELS][DECAY_WHEEL_SLOTS];
+			DecayEntry m_overflow;
+	};
+#endif
@@ -24,13 +24,45 @@
 	#include "exception.h"
 #endif
 
+#include "configmanager.h"
 #include "game.h"
+
+#ifdef __GNUC__
+	#include <cxxabi.h>
+#endif
+
+extern ConfigManager g_config;
 extern Game g_game;
 
 Dispatcher::DispatcherState Dispatcher::m_threadState = Dispatcher::STATE_TERMINATED;
 
+std::string Task::getOrigin() const {
+	if (!m_origin.empty() || m_f.empty()) {
+		return m_origin;
+	}
+
+	// fallback to the type of the bound functor, it names the class and signature of the callee
+	std::string origin = m_f.target_type().name();
+	#ifdef __GNUC__
+		int32_t status = 0;
+		if (char* demangled = abi::__cxa_demangle(origin.c_str(), NULL, NULL, &status)) {
+			origin = demangled;
+			free(demangled);
+		}
+	#endif
+
+	std::string::size_type pos = origin.find("_mfi::");
+	if (pos != std::string::npos) {
+		std::string::size_type end = origin.find(">,", pos);
+		origin = origin.substr(pos + 6, end != std::string::npos ? end - pos - 5 : std::string::npos);
+	}
+	return origin;
+}
+
 Dispatcher::Dispatcher() {
 	m_taskList.clear();
+	m_taskCount = 0;
+	m_slowTasks = 0;
 	Dispatcher::m_threadState = Dispatcher::STATE_RUNNING;
 	boost::thread(boost::bind(&Dispatcher::dispatcherThread, (void*)this));
 }
@@ -59,6 +91,7 @@ void Dispatcher::dispatcherThread(void* p) {
 			// take the first task
 			task = dispatcher->m_taskList.front();
 			dispatcher->m_taskList.pop_front();
+			dispatcher->m_queueDepth.add(dispatcher->m_taskCount.fetch_sub(1, boost::memory_order_relaxed) - 1);
 		}
 
 		taskLockUnique.unlock();
@@ -68,6 +101,8 @@ void Dispatcher::dispatcherThread(void* p) {
 		}
 
 		if (!task->hasExpired()) {
+			int64_t start = OTSYS_TIME_MICRO();
+			dispatcher->m_queueLatency.add(std::max((int64_t)0, start - task->getQueued()));
 			if ((outputPool = OutputMessagePool::getInstance())) {
 				outputPool->startExecutionFrame();
 			}
@@ -76,7 +111,17 @@ void Dispatcher::dispatcherThread(void* p) {
 			if (outputPool) {
 				outputPool->sendAll();
 			}
+
 			g_game.clearSpectatorCache();
+			int64_t duration = OTSYS_TIME_MICRO() - start;
+
+			dispatcher->m_taskDuration.add(std::max((int64_t)0, duration));
+			if (int32_t budget = g_config.getNumber(ConfigManager::DISPATCHER_TASK_BUDGET)) {
+				if (duration > (int64_t)budget * 1000) {
+					dispatcher->m_slowTasks.fetch_add(1, boost::memory_order_relaxed);
+					std::clog << "[Warning - Dispatcher::dispatcherThread] Task took " << duration / 1000 << " ms (budget " << budget << " ms): " << task->getOrigin() << std::endl;
+				}
+			}
 		}
 		delete task;
 	}
@@ -91,11 +136,14 @@ void Dispatcher::addTask(Task* task, bool front) {
 	m_taskLock.lock();
 	if (Dispatcher::m_threadState == Dispatcher::STATE_RUNNING) {
 		signal = m_taskList.empty();
+		task->setQueued(OTSYS_TIME_MICRO());
 		if (front) {
 			m_taskList.push_front(task);
 		} else {
 			m_taskList.push_back(task);
 		}
+
+		m_taskCount.fetch_add(1, boost::memory_order_relaxed);
 	}
 
 	#ifdef __DEBUG_SCHEDULER__
@@ -117,6 +165,7 @@ void Dispatcher::flush() {
 	while (!m_taskList.empty()) {
 		task = m_taskList.front();
 		m_taskList.pop_front();
+		m_taskCount.fetch_sub(1, boost::memory_order_relaxed);
 
 		(*task)();
 		delete task;
@@ -19,6 +19,7 @@
 	#define __TASKS__
 
 	#include "otsystem.h"
+	#include "metrics.h"
 
 	#include <boost/function.hpp>
 	#define DISPATCHER_TASK_EXPIRATION 2000
@@ -26,8 +27,8 @@
 	class Task {
 		public:
 			Task(const boost::function<void (void)>& f):
-				m_expiration(boost::date_time::not_a_date_time), m_f(f) {}
-			Task(uint32_t ms, const boost::function<void (void)>& f):m_expiration(boost::get_system_time() + boost::posix_time::milliseconds(ms)), m_f(f) {}
+				m_expiration(boost::date_time::not_a_date_time), m_f(f), m_queued(0) {}
+			Task(uint32_t ms, const boost::function<void (void)>& f):m_expiration(boost::get_system_time() + boost::posix_time::milliseconds(ms)), m_f(f), m_queued(0) {}
 
 			virtual ~Task() {}
 			void operator()() {
@@ -44,9 +45,24 @@
 				return m_expiration < boost::get_system_time();
 			}
 
+			void setOrigin(const std::string& origin) {
+				m_origin = origin;
+			}
+			std::string getOrigin() const;
+
+			void setQueued(int64_t queued) {
+				m_queued = queued;
+			}
+			int64_t getQueued() const {
+				return m_queued;
+			}
+
 		protected:
 			boost::system_time m_expiration;
 			boost::function<void (void)> m_f;
+
+			std::string m_origin;
+			int64_t m_queued;
 	};
 
 	inline Task* createTask(boost::function<void (void)> f) {
@@ -72,6 +88,23 @@
 
 			static void dispatcherThread(void* p);
 
+			uint32_t getTaskCount() const {
+				return m_taskCount.load(boost::memory_order_relaxed);
+			}
+			uint64_t getSlowTaskCount() const {
+				return m_slowTasks.load(boost::memory_order_relaxed);
+			}
+
+			const Histogram& getTaskDuration() const {
+				return m_taskDuration;
+			}
+			const Histogram& getQueueLatency() const {
+				return m_queueLatency;
+			}
+			const Histogram& getQueueDepth() const {
+				return m_queueDepth;
+			}
+
 		protected:
 			void flush();
 
@@ -87,5 +120,9 @@
 
 			std::list<Task*> m_taskList;
 			static DispatcherState m_threadState;
+
+			boost::atomic<uint32_t> m_taskCount;
+			MetricCounter m_slowTasks;
+			Histogram m_taskDuration, m_queueLatency, m_queueDepth;
 	};
 #endif
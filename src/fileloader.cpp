@@ -18,9 +18,15 @@
 #include "otpch.h"
 #include "fileloader.h"
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 FileLoader::FileLoader() {
 	m_file = NULL;
 	m_root = NULL;
+	m_region = NULL;
+	m_data = NULL;
+	m_size = 0;
 	m_buffer = new uint8_t[1024];
 	m_buffer_size = 1024;
 	m_lastError = ERROR_NONE;
@@ -44,6 +50,8 @@ FileLoader::~FileLoader() {
 	}
 
 	NodeStruct::clearNet(m_root);
+	closeMapped();
+
 	delete[] m_buffer;
 	for (int32_t i = 0; i < CACHE_BLOCKS; i++) {
 		if (m_cached_data[i].data) {
@@ -52,8 +60,19 @@ FileLoader::~FileLoader() {
 	}
 }
 
-bool FileLoader::openFile(std::string name, bool write, bool caching) {
+bool FileLoader::openFile(std::string name, bool write, bool caching, bool mapping) {
 	uint32_t version = 0;
+	if (!write && mapping) {
+		if (openMapped(name)) {
+			return true;
+		}
+
+		if (m_lastError != ERROR_NONE) {
+			return false;
+		}
+		// could not map it (compressed or missing), read it through the stream instead
+	}
+
 	if (write) {
 		#ifdef __USE_ZLIB__
 			m_file = gzopen(name.c_str(), "wb");
@@ -249,11 +268,150 @@ bool FileLoader::parseNode(NODE node) {
 	return false;
 }
 
+bool FileLoader::openMapped(const std::string& name) {
+	try {
+		boost::interprocess::file_mapping file(name.c_str(), boost::interprocess::read_only);
+		// copy on write, parseMapped unescapes the properties in place
+		m_region = new boost::interprocess::mapped_region(file, boost::interprocess::copy_on_write);
+	} catch (boost::interprocess::interprocess_exception&) {
+		m_region = NULL;
+		return false;
+	}
+
+	m_data = (uint8_t*)m_region->get_address();
+	m_size = m_region->get_size();
+
+	uint32_t version = 0;
+	if (m_size < 6 || m_size != m_region->get_size()) {
+		closeMapped();
+		return false;
+	}
+
+	memcpy(&version, m_data, sizeof(version));
+	if (version > 0 || m_data[4] != NODE_START) {
+		closeMapped();
+		return false;
+	}
+
+	m_root = new NodeStruct();
+	m_root->start = 4;
+	if (parseMapped()) {
+		return true;
+	}
+
+	NodeStruct::clearNet(m_root);
+	m_root = NULL;
+
+	closeMapped();
+	return false;
+}
+
+bool FileLoader::parseMapped() {
+	// one pass over the whole file, builds the node tree without recursion and
+	// compacts escaped properties in place, so getProps can return the mapping
+	std::vector<std::pair<NODE, NODE> > parents;
+	NODE currentNode = m_root, lastChild = NULL;
+
+	currentNode->type = m_data[5];
+	uint32_t pos = 6, write = pos;
+
+	bool inProps = true;
+	while (pos < m_size) {
+		uint8_t byte = m_data[pos];
+		switch (byte) {
+			case NODE_START: {
+				if (inProps) {
+					currentNode->propsSize = write - currentNode->start - 2;
+					inProps = false;
+				}
+
+				if (pos + 1 >= m_size) {
+					m_lastError = ERROR_EOF;
+					return false;
+				}
+
+				NODE childNode = new NodeStruct();
+				childNode->start = pos;
+				childNode->type = m_data[pos + 1];
+				if (lastChild) {
+					lastChild->next = childNode;
+				} else {
+					currentNode->child = childNode;
+				}
+
+				parents.push_back(std::make_pair(currentNode, childNode));
+				currentNode = childNode;
+				lastChild = NULL;
+
+				pos += 2;
+				write = pos;
+				inProps = true;
+				break;
+			}
+
+			case NODE_END: {
+				if (inProps) {
+					currentNode->propsSize = write - currentNode->start - 2;
+					inProps = false;
+				}
+
+				++pos;
+				if (parents.empty()) {
+					return true; // root node closed
+				}
+
+				currentNode = parents.back().first;
+				lastChild = parents.back().second;
+				parents.pop_back();
+				break;
+			}
+
+			case ESCAPE_CHAR: {
+				if (++pos >= m_size) {
+					m_lastError = ERROR_EOF;
+					return false;
+				}
+
+				byte = m_data[pos];
+				// fall through
+			}
+
+			default: {
+				if (inProps) {
+					if (write != pos) { // do not dirty pages that need no compacting
+						m_data[write] = byte;
+					}
+					++write;
+				}
+
+				++pos;
+				break;
+			}
+		}
+	}
+
+	m_lastError = ERROR_EOF;
+	return false;
+}
+
+void FileLoader::closeMapped() {
+	delete m_region;
+	m_region = NULL;
+
+	m_data = NULL;
+	m_size = 0;
+}
+
 const uint8_t* FileLoader::getProps(const NODE node, uint32_t &size) {
 	if (!node) {
 		return NULL;
 	}
 
+	if (m_data) {
+		size = node->propsSize;
+		return m_data + node->start + 2;
+	}
+
 	if (node->propsSize >= m_buffer_size) {
 		delete[] m_buffer;
 		m_buffer = new uint8_t[m_buffer_size + 1024];
@@ -23,6 +23,12 @@
 		#include <zlib.h>
 	#endif
 
+	namespace boost {
+		namespace interprocess {
+			class mapped_region;
+		}
+	}
+
 	struct NodeStruct;
 	typedef NodeStruct* NODE;
 
@@ -94,7 +100,7 @@
 			FileLoader();
 			virtual ~FileLoader();
 
-			bool openFile(std::string name, bool write, bool caching = false);
+			bool openFile(std::string name, bool write, bool caching = false, bool mapping = false);
 			const uint8_t* getProps(const NODE, uint32_t &size);
 			bool getProps(const NODE, PropStream& props);
 			NODE getChildNode(const NODE& parent, uint32_t &type) const;
@@ -104,6 +110,12 @@
 			void endNode();
 			int32_t setProps(void* data, uint16_t size);
 
+			// a mapped file is indexed and unescaped up front, so getProps never
+			// touches shared state and may be called from several threads at once
+			bool isMapped() const {
+				return m_data != NULL;
+			}
+
 			int32_t getError() const {
 				return m_lastError;
 			}
@@ -116,6 +128,10 @@
 				NODE_START = 0xFE, NODE_END = 0xFF, ESCAPE_CHAR = 0xFD, };
 			bool parseNode(NODE node);
 
+			bool openMapped(const std::string& name);
+			bool parseMapped();
+			void closeMapped();
+
 			inline bool readByte(int32_t &value);
 			inline bool readBytes(unsigned char* buffer, int32_t size, int32_t pos);
 			inline bool checks(const NODE& node);
@@ -165,6 +181,10 @@
 			#endif
 
 			NODE m_root;
+			boost::interprocess::mapped_region* m_region;
+			uint8_t* m_data;
+			uint32_t m_size;
+
 			uint32_t m_buffer_size;
 			uint8_t* m_buffer;
 
@@ -13,6 +13,8 @@
 #endif
 
 #include "server.h"
+#include "metrics.h"
+#include "status.h"
 #include "chat.h"
 
 #include "luascript.h"
@@ -31,6 +33,8 @@
 #include "monsters.h"
 
 #include "house.h"
+#include "iomapserialize.h"
+#include "job.h"
 #include "quests.h"
 
 #include "actions.h"
@@ -61,10 +65,12 @@ extern Weapons* g_weapons;
 extern CreatureEvents* g_creatureEvents;
 extern GlobalEvents* g_globalEvents;
 
-Game::Game() {
+Game::Game():
+	decayWheel(EVENT_DECAYINTERVAL) {
 	gameState = GAMESTATE_NORMAL;
 	worldType = WORLDTYPE_OPEN;
 	map = NULL;
+	combatBatch = NULL;
 	playersRecord = lastStageLevel = 0;
 	for (int32_t i = 0; i < 3; i++) {
 		globalSaveMessage[i] = false;
@@ -76,7 +82,7 @@ Game::Game() {
 	lightLevel = LIGHT_LEVEL_DAY;
 	lightState = LIGHT_STATE_DAY;
 
-	lastBucket = checkCreatureLastIndex = checkLightEvent = checkCreatureEvent = checkDecayEvent = saveEvent = 0;
+	checkCreatureLastIndex = checkLightEvent = checkCreatureEvent = checkDecayEvent = saveEvent = 0;
 
 	#ifdef __WAR_SYSTEM__
 		checkWarsEvent = 0;
@@ -97,6 +103,7 @@ void Game::start(ServiceManager* servicer) {
 	#endif
 
 	services = servicer;
+	Status::getInstance()->refresh();
 	if (!g_config.getBool(ConfigManager::GLOBALSAVE_ENABLED) || g_config.getNumber(ConfigManager::GLOBALSAVE_H) < 1 || g_config.getNumber(ConfigManager::GLOBALSAVE_H) > 24 || g_config.getNumber(ConfigManager::GLOBALSAVE_M) < 0 || g_config.getNumber(ConfigManager::GLOBALSAVE_M) > 59) {
 		return;
 	}
@@ -214,7 +221,7 @@ void Game::setGameState(GameState_t newState) {
 					}
 				}
 
-				saveGameState(false);
+				proceduralSave(false);
 				break;
 			}
 
@@ -230,29 +237,19 @@ void Game::setGameState(GameState_t newState) {
 }
 
 void Game::saveGameState(bool shallow) {
-	std::clog << "> Saving server..." << std::endl;
-	uint64_t start = OTSYS_TIME();
 	if (gameState == GAMESTATE_NORMAL) {
 		setGameState(GAMESTATE_MAINTAIN);
 	}
 
-	IOLoginData* io = IOLoginData::getInstance();
-	for (AutoList<Player>::iterator it = Player::autoList.begin(); it != Player::autoList.end(); ++it) {
-		it->second->loginPosition = it->second->getPosition();
-		io->savePlayer(it->second, false, shallow);
-	}
-
-	std::string storage = "relational";
-	if (g_config.getBool(ConfigManager::HOUSE_STORAGE)) {
-		storage = "binary";
-	}
-
-	map->saveMap();
-	ScriptEnviroment::saveGameState();
+	SaveJob job(shallow);
+	Jobs::getInstance()->run(job);
 	if (gameState == GAMESTATE_MAINTAIN) {
 		setGameState(GAMESTATE_NORMAL);
 	}
-	std::clog << "> SAVE: Complete in " << (OTSYS_TIME() - start) / (1000.) << " seconds using " << storage << " house storage." << std::endl;
+}
+
+void Game::proceduralSave(bool shallow) {
+	Jobs::getInstance()->add(new SaveJob(shallow));
 }
 
 int32_t Game::loadMap(std::string filename) {
@@ -268,203 +265,112 @@ int32_t Game::loadMap(std::string filename) {
 }
 
 void Game::cleanMapEx(uint32_t& count) {
-	uint64_t start = OTSYS_TIME();
-	uint32_t tiles = 0; count = 0;
-
-	int32_t marked = -1;
 	if (gameState == GAMESTATE_NORMAL) {
 		setGameState(GAMESTATE_MAINTAIN);
 	}
 
-	Tile* tile = NULL;
-	ItemVector::iterator tit;
-	if (g_config.getBool(ConfigManager::STORE_TRASH)) {
-		marked = trash.size();
-		Trash::iterator it = trash.begin();
-		if (g_config.getBool(ConfigManager::CLEAN_PROTECTED_ZONES)) {
-			for (; it != trash.end(); ++it) {
-				if (!(tile = getTile(*it))) {
-					continue;
-				}
-
-				tile->resetFlag(TILESTATE_TRASHED);
-				if (tile->hasFlag(TILESTATE_HOUSE) || !tile->getItemList()) {
-					continue;
-				}
-
-				++tiles;
-				tit = tile->getItemList()->begin();
-				while (tile->getItemList() && tit != tile->getItemList()->end()) {
-					if ((*tit)->isMovable() && !(*tit)->isLoadedFromMap() && !(*tit)->isScriptProtected()) {
-						internalRemoveItem(NULL, *tit);
-						if (tile->getItemList()) {
-							tit = tile->getItemList()->begin();
-						}
-						++count;
-					} else {
-						++tit;
-					}
-				}
-			}
-			trash.clear();
-		} else {
-			for (; it != trash.end(); ++it) {
-				if (!(tile = getTile(*it))) {
-					continue;
-				}
+	CleanJob job;
+	Jobs::getInstance()->run(job);
+	if (gameState == GAMESTATE_MAINTAIN) {
+		setGameState(GAMESTATE_NORMAL);
+	}
 
-				tile->resetFlag(TILESTATE_TRASHED);
-				if (tile->hasFlag(TILESTATE_PROTECTIONZONE) || !tile->getItemList()) {
-					continue;
-				}
+	count = job.getItems();
+}
 
-				++tiles;
-				tit = tile->getItemList()->begin();
-				while (tile->getItemList() && tit != tile->getItemList()->end()) {
-					if ((*tit)->isMovable() && !(*tit)->isLoadedFromMap() && !(*tit)->isScriptProtected()) {
-						internalRemoveItem(NULL, *tit);
-						if (tile->getItemList()) {
-							tit = tile->getItemList()->begin();
-						}
-						++count;
-					} else {
-						++tit;
-					}
-				}
-			}
-			trash.clear();
-		}
-	} else if (g_config.getBool(ConfigManager::CLEAN_PROTECTED_ZONES)) {
-		for (uint16_t z = 0; z < (uint16_t)MAP_MAX_LAYERS; z++) {
-			for (uint16_t y = 1; y <= map->mapHeight; y++) {
-				for (uint16_t x = 1; x <= map->mapWidth; x++) {
-					if (!(tile = getTile(x, y, z)) || tile->hasFlag(TILESTATE_HOUSE) || !tile->getItemList()) {
-						continue;
-					}
+void Game::cleanMap() {
+	Jobs::getInstance()->add(new CleanJob());
+}
 
-					++tiles;
-					tit = tile->getItemList()->begin();
-					while (tile->getItemList() && tit != tile->getItemList()->end()) {
-						if ((*tit)->isMovable() && !(*tit)->isLoadedFromMap() && !(*tit)->isScriptProtected()) {
-							internalRemoveItem(NULL, *tit);
-							if (tile->getItemList()) {
-								tit = tile->getItemList()->begin();
-							}
-							++count;
-						} else {
-							++tit;
-						}
-					}
-				}
-			}
-		}
-	} else {
-		for (uint16_t z = 0; z < (uint16_t)MAP_MAX_LAYERS; z++) {
-			for (uint16_t y = 1; y <= map->mapHeight; y++) {
-				for (uint16_t x = 1; x <= map->mapWidth; x++) {
-					if (!(tile = getTile(x, y, z)) || tile->hasFlag(TILESTATE_PROTECTIONZONE) || !tile->getItemList()) {
-						continue;
-					}
+uint32_t Game::cleanTile(Tile* tile) {
+	if (tile->hasFlag(g_config.getBool(ConfigManager::CLEAN_PROTECTED_ZONES) ? TILESTATE_HOUSE : TILESTATE_PROTECTIONZONE)) {
+		return 0;
+	}
 
-					++tiles;
-					tit = tile->getItemList()->begin();
-					while (tile->getItemList() && tit != tile->getItemList()->end()) {
-						if ((*tit)->isMovable() && !(*tit)->isLoadedFromMap() && !(*tit)->isScriptProtected()) {
-							internalRemoveItem(NULL, *tit);
-							if (tile->getItemList()) {
-								tit = tile->getItemList()->begin();
-							}
-							++count;
-						} else {
-							++tit;
-						}
-					}
-				}
-			}
-		}
+	TileItemVector* items = tile->getItemList();
+	if (!items) {
+		return 0;
 	}
 
-	if (gameState == GAMESTATE_MAINTAIN) {
-		setGameState(GAMESTATE_NORMAL);
+	// collect first, removing while walking the list would restart the scan on every item
+	ItemVector remove;
+	for (ItemVector::iterator it = items->begin(); it != items->end(); ++it) {
+		if ((*it)->isMovable() && !(*it)->isLoadedFromMap() && !(*it)->isScriptProtected()) {
+			remove.push_back(*it);
+		}
 	}
 
-	std::clog << "> CLEAN: Removed " << count << " item" << (count != 1 ? "s" : "") << " from " << tiles << " tile" << (tiles != 1 ? "s" : "");
-	if (marked >= 0) {
-		std::clog << " (" << marked << " were marked)";
+	// back to front, so every erase only shifts the few items behind it
+	uint32_t count = 0;
+	for (ItemVector::reverse_iterator it = remove.rbegin(); it != remove.rend(); ++it) {
+		if ((*it)->getParent() == tile && internalRemoveItem(NULL, *it) == RET_NOERROR) {
+			++count;
+		}
 	}
 
-	std::clog << " in " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
+	return count;
 }
 
-void Game::cleanMap() {
-	uint32_t dummy;
-	cleanMapEx(dummy);
+void Game::proceduralRefresh() {
+	Jobs::getInstance()->add(new RefreshJob());
 }
 
-void Game::proceduralRefresh(RefreshTiles::iterator* it) {
-	if (!it) {
-		it = new RefreshTiles::iterator(refreshTiles.begin());
+bool Game::isRefreshed(const Item* item, const Item* prototype) const {
+	if (item->getID() != prototype->getID() || item->getSubType() != prototype->getSubType() || item->getText() != prototype->getText()) {
+		return false;
 	}
 
-	// Refresh 250 tiles each cycle
-	refreshMap(it, 250);
-	if ((*it) != refreshTiles.end()) {
-		delete it;
-		return;
+	const Container* container = item->getContainer();
+	if (!container) {
+		return true;
 	}
 
-	// Refresh some items every 100 ms until all tiles has been checked
-	// For 100k tiles, this would take 100000/2500 = 40s = half a minute
-	Scheduler::getInstance().addEvent(createSchedulerTask(100, boost::bind(&Game::proceduralRefresh, this, it)));
-}
-
-void Game::refreshMap(RefreshTiles::iterator* it, uint32_t limit) {
-	RefreshTiles::iterator end = refreshTiles.end();
-	if (!it) {
-		RefreshTiles::iterator begin = refreshTiles.begin();
-		it = &begin;
+	const Container* original = prototype->getContainer();
+	if (!original || container->size() != original->size()) {
+		return false;
 	}
 
-	Tile* tile = NULL;
-	TileItemVector* items = NULL;
+	for (ItemList::const_iterator it = container->getItems(), oit = original->getItems(); it != container->getEnd(); ++it, ++oit) {
+		if (!isRefreshed(*it, *oit)) {
+			return false;
+		}
+	}
+	return true;
+}
 
-	Item* item = NULL;
-	for (uint32_t cleaned = 0, downItemsSize = 0; (*it) != end && (limit ? (cleaned < limit) : true); ++(*it), ++cleaned) {
-		if (!(tile = (*it)->first)) {
-			continue;
+bool Game::refreshTile(Tile* tile, const RefreshBlock_t& rb) {
+	const ItemVector& list = *rb.list;
+	if (const TileItemVector* items = tile->getItemList()) {
+		if (items->getDownItemCount() == list.size() && std::equal(items->getBeginDownItem(), items->getEndDownItem(), list.begin(),
+			boost::bind(&Game::isRefreshed, this, _1, _2))) {
+			return false; // nothing was touched since the last refresh
 		}
+	} else if (list.empty()) {
+		return false;
+	}
 
-		if ((items = tile->getItemList())) {
-			downItemsSize = tile->getDownItemCount();
-			for (uint32_t i = downItemsSize - 1; i; --i) {
-				if ((item = items->at(i))) {
-					#ifndef __DEBUG__
-						internalRemoveItem(NULL, item);
-					#else
-						if (internalRemoveItem(NULL, item) != RET_NOERROR) {
-							std::clog << "> WARNING: Could not refresh item: " << item->getID();
-							std::clog << " at position: " << tile->getPosition() << std::endl;
-						}
-					#endif
-				}
-			}
+	ItemVector clones, removed;
+	for (ItemVector::const_iterator it = list.begin(); it != list.end(); ++it) {
+		if (Item* item = (*it)->clone()) {
+			item->setLoadedFromMap(true);
+			clones.push_back(item);
 		}
+	}
 
-		cleanup();
-		TileItemVector list = (*it)->second.list;
-		for (ItemVector::reverse_iterator it = list.rbegin(); it != list.rend(); ++it) {
-			Item* item = (*it)->clone();
-			if (internalAddItem(NULL, tile, item, INDEX_WHEREEVER, FLAG_NOLIMIT) == RET_NOERROR) {
-				if (item->getUniqueId() != 0) {
-					ScriptEnviroment::addUniqueThing(item);
-				}
-				startDecay(item);
-			} else {
-				std::clog << "> WARNING: Could not refresh item: " << item->getID() << " at position: " << tile->getPosition() << std::endl;
-				delete item;
-			}
+	tile->resetDownItems(clones, removed);
+	for (ItemVector::iterator it = removed.begin(); it != removed.end(); ++it) {
+		freeThing(*it);
+		(*it)->onRemoved();
+	}
+
+	for (ItemVector::iterator it = clones.begin(); it != clones.end(); ++it) {
+		if ((*it)->getUniqueId()) {
+			ScriptEnviroment::addUniqueThing(*it);
 		}
+
+		startDecay(*it);
 	}
+	return true;
 }
 
 bool Game::isSwimmingPool(Item* item, const Tile* tile, bool checkProtection) const {
@@ -813,6 +719,9 @@ bool Game::internalPlaceCreature(Creature* creature, const Position& pos, bool e
 
 	autoList[creature->getID()] = creature;
 	creature->addList();
+	if (creature->getPlayer()) {
+		Spawns::getInstance()->onPlayerEnter(creature->getPosition());
+	}
 	return true;
 }
 
@@ -2660,6 +2569,10 @@ bool Game::playerWriteItem(uint32_t playerId, uint32_t windowTextId, const std::
 		writeItem->resetDate();
 	}
 
+	if (House* house = Houses::getInstance()->getHouseByItem(writeItem)) {
+		house->setDirty(true);
+	}
+
 	uint16_t newId = Item::items[writeItem->getID()].writeOnceItemId;
 	if (newId != 0) {
 		transformItem(writeItem, newId);
@@ -3802,14 +3715,21 @@ bool Game::internalCreatureSay(Creature* creature, SpeakClasses type, const std:
 
 	// send to client
 	Player* tmpPlayer = NULL;
+	NetworkFragment_ptr fragment;
 	for (it = list.begin(); it != list.end(); ++it) {
 		if (!(tmpPlayer = (*it)->getPlayer())) {
 			continue;
 		}
 
-		if (!ghostMode || tmpPlayer->canSeeCreature(creature)) {
-			tmpPlayer->sendCreatureSay(creature, type, text, &destPos);
+		if (ghostMode && !tmpPlayer->canSeeCreature(creature)) {
+			continue;
+		}
+
+		if (!fragment) {
+			fragment = ProtocolGame::encodeCreatureSay(creature, type, text, &destPos);
 		}
+
+		tmpPlayer->sendCreatureSay(fragment);
 	}
 
 	// event method
@@ -3920,12 +3840,16 @@ void Game::checkCreatures() {
 	}
 
 	toAddCheckCreatureVector.clear();
+	uint32_t checked = 0;
+
 	std::vector<Creature*>& checkCreatureVector = checkCreatureVectors[checkCreatureLastIndex];
 	for (it = checkCreatureVector.begin(); it != checkCreatureVector.end();) {
 		if ((*it)->checked) {
 			if ((*it)->getHealth() > 0 || !(*it)->onDeath()) {
 				(*it)->onThink(EVENT_CREATURE_THINK_INTERVAL);
 			}
+
+			++checked;
 			++it;
 		} else {
 			(*it)->checkVector = -1;
@@ -3933,6 +3857,20 @@ void Game::checkCreatures() {
 			it = checkCreatureVector.erase(it);
 		}
 	}
+
+	uint32_t active = toAddCheckCreatureVector.size();
+	for (int32_t i = 0; i < EVENT_CREATURECOUNT; ++i) {
+		active += checkCreatureVectors[i].size();
+	}
+
+	Metrics* metrics = Metrics::getInstance();
+	metrics->add(METRIC_CREATURE_TICKS);
+	metrics->add(METRIC_CREATURES_CHECKED, checked);
+	metrics->set(METRIC_CREATURES_ACTIVE, active);
+
+	metrics->set(METRIC_PLAYERS_ONLINE, getPlayersOnline());
+	metrics->set(METRIC_MONSTERS_ONLINE, getMonstersOnline());
+	metrics->set(METRIC_NPCS_ONLINE, getNpcsOnline());
 	cleanup();
 }
 
@@ -4071,6 +4009,7 @@ bool Game::combatBlockHit(CombatType_t combatType, Creature* attacker, Creature*
 
 bool Game::combatChangeHealth(CombatType_t combatType, Creature* attacker, Creature* target, int32_t healthChange, MagicEffect_t hitEffect, Color_t hitColor, bool force) {
 	const Position& targetPos = target->getPosition();
+	CombatBatch* batch = getCombatBatch(targetPos);
 	if (healthChange > 0) {
 		if (!force && target->getHealth() <= 0) {
 			return false;
@@ -4093,16 +4032,16 @@ bool Game::combatChangeHealth(CombatType_t combatType, Creature* attacker, Creat
 			char buffer[20];
 			sprintf(buffer, "+%d", healthChange);
 
-			const SpectatorVec& list = getSpectators(targetPos);
+			const SpectatorVec& list = batch ? batch->spectators : getSpectators(targetPos);
 			if (combatType != COMBAT_HEALING) {
-				addMagicEffect(list, targetPos, MAGIC_EFFECT_WRAPS_BLUE);
+				addCombatEffect(batch, list, targetPos, MAGIC_EFFECT_WRAPS_BLUE);
 			}
-			addAnimatedText(list, targetPos, COLOR_GREEN, buffer);
+			addCombatText(batch, list, targetPos, COLOR_GREEN, buffer);
 		}
 	} else {
-		const SpectatorVec& list = getSpectators(targetPos);
+		const SpectatorVec& list = batch ? batch->spectators : getSpectators(targetPos);
 		if (!target->isAttackable() || Combat::canDoCombat(attacker, target) != RET_NOERROR) {
-			addMagicEffect(list, targetPos, MAGIC_EFFECT_POFF);
+			addCombatEffect(batch, list, targetPos, MAGIC_EFFECT_POFF);
 			return true;
 		}
 
@@ -4128,8 +4067,8 @@ bool Game::combatChangeHealth(CombatType_t combatType, Creature* attacker, Creat
 					char buffer[20];
 					sprintf(buffer, "%d", manaDamage);
 
-					addMagicEffect(list, targetPos, MAGIC_EFFECT_LOSE_ENERGY);
-					addAnimatedText(list, targetPos, COLOR_BLUE, buffer);
+					addCombatEffect(batch, list, targetPos, MAGIC_EFFECT_LOSE_ENERGY);
+					addCombatText(batch, list, targetPos, COLOR_BLUE, buffer);
 				}
 			}
 
@@ -4147,8 +4086,7 @@ bool Game::combatChangeHealth(CombatType_t combatType, Creature* attacker, Creat
 					return false;
 				}
 
-				target->drainHealth(attacker, combatType, damage);
-				addCreatureHealth(list, target);
+				target->drainHealth(attacker, combatType, damage); // sends the health bar itself
 
 				Color_t textColor = COLOR_NONE;
 				MagicEffect_t magicEffect = MAGIC_EFFECT_NONE;
@@ -4265,8 +4203,8 @@ bool Game::combatChangeHealth(CombatType_t combatType, Creature* attacker, Creat
 					char buffer[20];
 					sprintf(buffer, "%d", damage);
 
-					addMagicEffect(list, targetPos, magicEffect);
-					addAnimatedText(list, targetPos, textColor, buffer);
+					addCombatEffect(batch, list, targetPos, magicEffect);
+					addCombatText(batch, list, targetPos, textColor, buffer);
 				}
 			}
 		}
@@ -4276,6 +4214,7 @@ bool Game::combatChangeHealth(CombatType_t combatType, Creature* attacker, Creat
 
 bool Game::combatChangeMana(Creature* attacker, Creature* target, int32_t manaChange) {
 	const Position& targetPos = target->getPosition();
+	CombatBatch* batch = getCombatBatch(targetPos);
 	if (manaChange > 0) {
 		bool deny = false;
 		CreatureEventList statsChangeEvents = target->getCreatureEvents(CREATURE_EVENT_STATSCHANGE);
@@ -4294,20 +4233,20 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, int32_t manaCh
 			char buffer[20];
 			sprintf(buffer, "+%d", manaChange);
 
-			const SpectatorVec& list = getSpectators(targetPos);
-			addAnimatedText(list, targetPos, COLOR_DARKPURPLE, buffer);
+			const SpectatorVec& list = batch ? batch->spectators : getSpectators(targetPos);
+			addCombatText(batch, list, targetPos, COLOR_DARKPURPLE, buffer);
 		}
 	} else {
-		const SpectatorVec& list = getSpectators(targetPos);
+		const SpectatorVec& list = batch ? batch->spectators : getSpectators(targetPos);
 		if (!target->isAttackable() || Combat::canDoCombat(attacker, target) != RET_NOERROR) {
-			addMagicEffect(list, targetPos, MAGIC_EFFECT_POFF);
+			addCombatEffect(batch, list, targetPos, MAGIC_EFFECT_POFF);
 			return false;
 		}
 
 		int32_t manaLoss = std::min(target->getMana(), -manaChange);
 		BlockType_t blockType = target->blockHit(attacker, COMBAT_MANADRAIN, manaLoss);
 		if (blockType != BLOCK_NONE) {
-			addMagicEffect(list, targetPos, MAGIC_EFFECT_POFF);
+			addCombatEffect(batch, list, targetPos, MAGIC_EFFECT_POFF);
 			return false;
 		}
 
@@ -4328,23 +4267,170 @@ bool Game::combatChangeMana(Creature* attacker, Creature* target, int32_t manaCh
 			char buffer[20];
 			sprintf(buffer, "%d", manaLoss);
 
-			addAnimatedText(list, targetPos, COLOR_BLUE, buffer);
+			addCombatText(batch, list, targetPos, COLOR_BLUE, buffer);
 		}
 	}
 	return true;
 }
 
+void Game::startCombatBatch(CombatBatch& batch, const Position& centerPos, int32_t rangeX, int32_t rangeY) {
+	batch.centerPos = centerPos;
+	batch.rangeX = rangeX;
+	batch.rangeY = rangeY;
+	getSpectators(batch.spectators, centerPos, false, true, rangeX + Map::maxViewportX, rangeX + Map::maxViewportX,
+		rangeY + Map::maxViewportY, rangeY + Map::maxViewportY);
+	for (SpectatorVec::const_iterator it = batch.spectators.begin(); it != batch.spectators.end(); ++it) {
+		if ((*it)->getPlayer()) {
+			batch.hasPlayers = true;
+			break;
+		}
+	}
+
+	// casts triggered from within the cast (e.g. by scripts) get their own batch
+	batch.previous = combatBatch;
+	combatBatch = &batch;
+}
+
+void Game::finishCombatBatch(CombatBatch& batch) {
+	combatBatch = batch.previous;
+	if (batch.updates.empty()) {
+		return;
+	}
+
+	// health bars carry the health left after the whole cast
+	for (std::vector<CombatBatchUpdate>::iterator it = batch.updates.begin(); it != batch.updates.end(); ++it) {
+		if (it->type == BATCHUPDATE_HEALTH && !it->creature->isRemoved()) {
+			it->fragment = ProtocolGame::encodeCreatureHealth(it->creature);
+		}
+	}
+
+	Player* player = NULL;
+	for (SpectatorVec::const_iterator sit = batch.spectators.begin(); sit != batch.spectators.end(); ++sit) {
+		if (!(player = (*sit)->getPlayer())) {
+			continue;
+		}
+
+		for (std::vector<CombatBatchUpdate>::const_iterator it = batch.updates.begin(); it != batch.updates.end(); ++it) {
+			switch (it->type) {
+				case BATCHUPDATE_EFFECT: {
+					player->sendMagicEffect(it->pos, it->effect, it->fragment);
+					break;
+				}
+
+				case BATCHUPDATE_TEXT: {
+					player->sendAnimatedText(it->pos, it->fragment);
+					break;
+				}
+
+				case BATCHUPDATE_HEALTH: {
+					if (it->fragment) {
+						player->sendCreatureHealth(it->creature, it->fragment);
+					}
+					break;
+				}
+
+				default: {
+					break;
+				}
+			}
+		}
+	}
+
+	for (std::vector<CombatBatchUpdate>::iterator it = batch.updates.begin(); it != batch.updates.end(); ++it) {
+		if (it->type == BATCHUPDATE_HEALTH) {
+			it->creature->unRef();
+		}
+	}
+
+	batch.updates.clear();
+	batch.healthQueued.clear();
+}
+
+CombatBatch* Game::getCombatBatch(const Position& pos) const {
+	// the batch spectators only cover what can see the cast area
+	if (!combatBatch || pos.z != combatBatch->centerPos.z || std::abs(pos.x - combatBatch->centerPos.x) > combatBatch->rangeX
+		|| std::abs(pos.y - combatBatch->centerPos.y) > combatBatch->rangeY) {
+		return NULL;
+	}
+	return combatBatch;
+}
+
+void Game::addCombatHealth(CombatBatch* batch, Creature* target) {
+	if (!batch->hasPlayers || !batch->healthQueued.insert(target).second) {
+		return;
+	}
+
+	CombatBatchUpdate update;
+	update.type = BATCHUPDATE_HEALTH;
+	update.pos = target->getPosition();
+	update.effect = 0;
+	update.creature = target;
+
+	target->addRef();
+	batch->updates.push_back(update);
+}
+
+void Game::addCombatText(CombatBatch* batch, const SpectatorVec& list, const Position& pos, uint8_t textColor, const std::string& text) {
+	if (!batch) {
+		addAnimatedText(list, pos, textColor, text);
+		return;
+	}
+
+	if (!batch->hasPlayers) {
+		return;
+	}
+
+	CombatBatchUpdate update;
+	update.type = BATCHUPDATE_TEXT;
+	update.pos = pos;
+	update.effect = 0;
+	update.creature = NULL;
+	update.fragment = ProtocolGame::encodeAnimatedText(pos, textColor, text);
+	batch->updates.push_back(update);
+}
+
+void Game::addCombatEffect(CombatBatch* batch, const SpectatorVec& list, const Position& pos, uint8_t effect) {
+	if (!batch) {
+		addMagicEffect(list, pos, effect);
+		return;
+	}
+
+	if (!batch->hasPlayers) {
+		return;
+	}
+
+	CombatBatchUpdate update;
+	update.type = BATCHUPDATE_EFFECT;
+	update.pos = pos;
+	update.effect = effect;
+	update.creature = NULL;
+	update.fragment = ProtocolGame::encodeMagicEffect(pos, effect);
+	batch->updates.push_back(update);
+}
+
 void Game::addCreatureHealth(const Creature* target) {
+	if (CombatBatch* batch = getCombatBatch(target->getPosition())) {
+		addCombatHealth(batch, const_cast<Creature*>(target));
+		return;
+	}
+
 	const SpectatorVec& list = getSpectators(target->getPosition());
 	addCreatureHealth(list, target);
 }
 
 void Game::addCreatureHealth(const SpectatorVec& list, const Creature* target) {
 	Player* player = NULL;
+	NetworkFragment_ptr fragment;
 	for (SpectatorVec::const_iterator it = list.begin(); it != list.end(); ++it) {
-		if ((player = (*it)->getPlayer())) {
-			player->sendCreatureHealth(target);
+		if (!(player = (*it)->getPlayer())) {
+			continue;
 		}
+
+		if (!fragment) {
+			fragment = ProtocolGame::encodeCreatureHealth(target);
+		}
+
+		player->sendCreatureHealth(target, fragment);
 	}
 }
 
@@ -4369,10 +4455,17 @@ void Game::addAnimatedText(const Position& pos, uint8_t textColor, const std::st
 
 void Game::addAnimatedText(const SpectatorVec& list, const Position& pos, uint8_t textColor, const std::string& text) {
 	Player* player = NULL;
+	NetworkFragment_ptr fragment;
 	for (SpectatorVec::const_iterator it = list.begin(); it != list.end(); ++it) {
-		if ((player = (*it)->getPlayer())) {
-			player->sendAnimatedText(pos, textColor, text);
+		if (!(player = (*it)->getPlayer())) {
+			continue;
+		}
+
+		if (!fragment) {
+			fragment = ProtocolGame::encodeAnimatedText(pos, textColor, text);
 		}
+
+		player->sendAnimatedText(pos, fragment);
 	}
 }
 
@@ -4391,10 +4484,17 @@ void Game::addMagicEffect(const SpectatorVec& list, const Position& pos, uint8_t
 	}
 
 	Player* player = NULL;
+	NetworkFragment_ptr fragment;
 	for (SpectatorVec::const_iterator it = list.begin(); it != list.end(); ++it) {
-		if ((player = (*it)->getPlayer())) {
-			player->sendMagicEffect(pos, effect);
+		if (!(player = (*it)->getPlayer())) {
+			continue;
 		}
+
+		if (!fragment) {
+			fragment = ProtocolGame::encodeMagicEffect(pos, effect);
+		}
+
+		player->sendMagicEffect(pos, effect, fragment);
 	}
 }
 
@@ -4407,27 +4507,66 @@ void Game::addDistanceEffect(const Position& fromPos, const Position& toPos, uin
 
 void Game::addDistanceEffect(const SpectatorVec& list, const Position& fromPos, const Position& toPos, uint8_t effect) {
 	Player* player = NULL;
+	NetworkFragment_ptr fragment;
 	for (SpectatorVec::const_iterator it = list.begin(); it != list.end(); ++it) {
-		if ((player = (*it)->getPlayer())) {
-			player->sendDistanceShoot(fromPos, toPos, effect);
+		if (!(player = (*it)->getPlayer())) {
+			continue;
+		}
+
+		if (!fragment) {
+			fragment = ProtocolGame::encodeDistanceShoot(fromPos, toPos, effect);
 		}
+
+		player->sendDistanceShoot(fromPos, toPos, effect, fragment);
 	}
 }
 
 void Game::startDecay(Item* item) {
-	if (!item || !item->canDecay() || item->getDecaying() == DECAYING_TRUE) {
+	if (!item) {
 		return;
 	}
 
-	if (item->getDuration() > 0) {
+	if (!item->canDecay()) { // keeps the remaining duration
+		stopDecay(item);
+		return;
+	}
+
+	if (item->getDecaying() == DECAYING_TRUE) {
+		return;
+	}
+
+	if (item->isDecayScheduled()) { // a transformation already rescheduled it
+		item->setDecaying(DECAYING_TRUE);
+		return;
+	}
+
+	int32_t duration = item->getDuration();
+	if (duration > 0) {
 		item->addRef();
 		item->setDecaying(DECAYING_TRUE);
-		toDecayItems.push_back(item);
+		decayWheel.add(item, OTSYS_TIME() + duration);
 	} else {
 		internalDecayItem(item);
 	}
 }
 
+void Game::stopDecay(Item* item) {
+	if (!item->isDecayScheduled()) {
+		return;
+	}
+
+	int32_t duration = item->getDuration();
+	decayWheel.remove(item);
+
+	item->setDuration(duration);
+	item->setDecaying(DECAYING_FALSE);
+	freeThing(item);
+}
+
+void Game::updateDecay(Item* item, int32_t duration) {
+	decayWheel.update(item, OTSYS_TIME() + duration);
+}
+
 void Game::internalDecayItem(Item* item) {
 	const ItemType& it = Item::items.getItemType(item->getID());
 	if (it.decayTo) {
@@ -4444,42 +4583,21 @@ void Game::internalDecayItem(Item* item) {
 void Game::checkDecay() {
 	checkDecayEvent = Scheduler::getInstance().addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, boost::bind(&Game::checkDecay, this)));
 
-	size_t bucket = (lastBucket + 1) % EVENT_DECAYBUCKETS;
-	for (DecayList::iterator it = decayItems[bucket].begin(); it != decayItems[bucket].end();) {
+	ItemVector expired;
+	decayWheel.advance(OTSYS_TIME(), expired);
+	for (ItemVector::iterator it = expired.begin(); it != expired.end(); ++it) {
 		Item* item = *it;
-		int32_t decreaseTime = EVENT_DECAYINTERVAL * EVENT_DECAYBUCKETS;
-		if (item->getDuration() - decreaseTime < 0) {
-			decreaseTime = item->getDuration();
-		}
-
-		item->decreaseDuration(decreaseTime);
 		if (!item->canDecay()) {
 			item->setDecaying(DECAYING_FALSE);
 			freeThing(item);
-			it = decayItems[bucket].erase(it);
 			continue;
 		}
 
-		int32_t dur = item->getDuration();
-		if (dur <= 0) {
-			it = decayItems[bucket].erase(it);
-			internalDecayItem(item);
-			freeThing(item);
-		} else if (dur < EVENT_DECAYINTERVAL * EVENT_DECAYBUCKETS) {
-			it = decayItems[bucket].erase(it);
-			size_t newBucket = (bucket + ((dur + EVENT_DECAYINTERVAL / 2) / 1000)) % EVENT_DECAYBUCKETS;
-			if (newBucket == bucket) {
-				internalDecayItem(item);
-				freeThing(item);
-			} else {
-				decayItems[newBucket].push_back(item);
-			}
-		} else {
-			++it;
-		}
+		item->setDuration(0);
+		internalDecayItem(item);
+		freeThing(item);
 	}
 
-	lastBucket = bucket;
 	cleanup();
 }
 
@@ -5902,6 +6020,7 @@ void Game::globalSave() {
 
 void Game::shutdown() {
 	std::clog << "Preparing";
+	IOMapSerialize::getInstance()->flush();
 	Scheduler::getInstance().shutdown();
 	std::clog << " to";
 	Dispatcher::getInstance().shutdown();
@@ -5928,15 +6047,6 @@ void Game::cleanup() {
 	}
 
 	releaseThings.clear();
-	for (DecayList::iterator it = toDecayItems.begin(); it != toDecayItems.end(); ++it) {
-		int32_t dur = (*it)->getDuration();
-		if (dur >= EVENT_DECAYINTERVAL * EVENT_DECAYBUCKETS) {
-			decayItems[lastBucket].push_back(*it);
-		} else {
-			decayItems[(lastBucket + 1 + (*it)->getDuration() / 1000) % EVENT_DECAYBUCKETS].push_back(*it);
-		}
-	}
-	toDecayItems.clear();
 }
 
 void Game::freeThing(Thing* thing) {
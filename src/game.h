@@ -19,6 +19,7 @@
 	#define __GAME__
 
 	#include "otsystem.h"
+	#include <boost/tr1/unordered_set.hpp>
 
 	#include "enums.h"
 	#include "templates.h"
@@ -29,6 +30,7 @@
 	#include "spawn.h"
 
 	#include "item.h"
+	#include "decay.h"
 	#include "player.h"
 	#include "npc.h"
 	#include "monster.h"
@@ -115,20 +117,49 @@
 			RuleViolation(const RuleViolation&);
 	};
 
+	// the prototypes are cloned once at load and never change, refreshing only clones them again
 	struct RefreshBlock_t {
-		TileItemVector list;
+		shared_ptr<const ItemVector> list;
 		uint64_t lastRefresh;
 	};
 
+	enum CombatBatchUpdate_t {
+		BATCHUPDATE_EFFECT,
+		BATCHUPDATE_TEXT,
+		BATCHUPDATE_HEALTH
+	};
+
+	struct CombatBatchUpdate {
+		CombatBatchUpdate_t type;
+		Position pos;
+		uint8_t effect;
+		Creature* creature;
+		NetworkFragment_ptr fragment;
+	};
+
+	// hits of one area cast, sent to the spectators of the whole area in a single pass
+	struct CombatBatch {
+		CombatBatch(): rangeX(0), rangeY(0), hasPlayers(false), previous(NULL) {}
+
+		SpectatorVec spectators;
+		std::vector<CombatBatchUpdate> updates;
+		std::set<const Creature*> healthQueued;
+
+		Position centerPos;
+		int32_t rangeX, rangeY;
+		bool hasPlayers;
+
+		CombatBatch* previous;
+	};
+
 	typedef std::map<uint32_t, shared_ptr<RuleViolation> > RuleViolationsMap;
 	typedef std::map<Tile*, RefreshBlock_t> RefreshTiles;
 	typedef std::vector< std::pair<std::string, uint32_t> > Highscore;
-	typedef std::list<Position> Trash;
+	typedef std::tr1::unordered_set<Tile*> Trash;
 	typedef std::map<int32_t, float> StageList;
 
 	#define EVENT_LIGHTINTERVAL 10000
 	#define EVENT_DECAYINTERVAL 1000
-	#define EVENT_DECAYBUCKETS 16
 	#define STATE_DELAY 1000
 
 	#ifdef __WAR_SYSTEM__
@@ -566,20 +597,31 @@
 			void setGameState(GameState_t newState);
 
 			void saveGameState(bool shallow);
+			void proceduralSave(bool shallow);
 			void loadGameState();
 
 			void cleanMapEx(uint32_t& count);
 			void cleanMap();
+			uint32_t cleanTile(Tile* tile);
 
-			void refreshMap(RefreshTiles::iterator* it = NULL, uint32_t limit = 0);
-			void proceduralRefresh(RefreshTiles::iterator* it = NULL);
+			void proceduralRefresh();
+			bool refreshTile(Tile* tile, const RefreshBlock_t& rb);
 
-			void addTrash(Position pos) {
-				trash.push_back(pos);
+			void addTrash(Tile* tile) {
+				trash.insert(tile);
+			}
+			void removeTrash(Tile* tile) {
+				trash.erase(tile);
+			}
+			const Trash& getTrash() const {
+				return trash;
 			}
 			void addRefreshTile(Tile* tile, RefreshBlock_t rb) {
 				refreshTiles[tile] = rb;
 			}
+			const RefreshTiles& getRefreshTiles() const {
+				return refreshTiles;
+			}
 
 			// Events
 			void checkCreatureWalk(uint32_t creatureId);
@@ -597,6 +639,9 @@
 			bool combatChangeHealth(CombatType_t combatType, Creature* attacker, Creature* target, int32_t healthChange, MagicEffect_t hitEffect = MAGIC_EFFECT_UNKNOWN, Color_t hitColor = COLOR_UNKNOWN, bool force = false);
 			bool combatChangeMana(Creature* attacker, Creature* target, int32_t manaChange);
 
+			void startCombatBatch(CombatBatch& batch, const Position& centerPos, int32_t rangeX, int32_t rangeY);
+			void finishCombatBatch(CombatBatch& batch);
+
 			// animation help functions
 			void addCreatureHealth(const Creature* target);
 			void addCreatureHealth(const SpectatorVec& list, const Creature* target);
@@ -650,6 +695,8 @@
 				return lightHour;
 			}
 			void startDecay(Item* item);
+			void stopDecay(Item* item);
+			void updateDecay(Item* item, int32_t duration);
 
 		protected:
 			bool playerWhisper(Player* player, const std::string& text);
@@ -660,6 +707,13 @@
 			bool playerReportRuleViolation(Player* player, const std::string& text);
 			bool playerContinueReport(Player* player, const std::string& text);
 
+			bool isRefreshed(const Item* item, const Item* prototype) const;
+
+			CombatBatch* getCombatBatch(const Position& pos) const;
+			void addCombatHealth(CombatBatch* batch, Creature* target);
+			void addCombatText(CombatBatch* batch, const SpectatorVec& list, const Position& pos, uint8_t textColor, const std::string& text);
+			void addCombatEffect(CombatBatch* batch, const SpectatorVec& list, const Position& pos, uint8_t effect);
+
 			struct GameEvent {
 				int64_t tick;
 				int32_t type;
@@ -678,10 +732,7 @@
 			void checkDecay();
 			void internalDecayItem(Item* item);
 
-			typedef std::list<Item*> DecayList;
-			DecayList decayItems[EVENT_DECAYBUCKETS];
-			DecayList toDecayItems;
-			size_t lastBucket;
+			DecayWheel decayWheel;
 
 			static const int32_t LIGHT_LEVEL_DAY = 250;
 			static const int32_t LIGHT_LEVEL_NIGHT = 40;
@@ -695,6 +746,7 @@
 
 			ServiceManager* services;
 			Map* map;
+			CombatBatch* combatBatch;
 
 			std::string lastMotd;
 			int32_t lastMotdId;
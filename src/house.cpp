@@ -34,7 +34,7 @@ extern ConfigManager g_config;
 extern Game g_game;
 
 House::House(uint32_t houseId) {
-	guild = pendingTransfer = false;
+	guild = pendingTransfer = dirty = false;
 	name = "Ancient headquarter (Flat 1, Area 42)";
 	entry = Position();
 	id = houseId;
@@ -121,6 +121,7 @@ bool House::setOwnerEx(uint32_t guid, bool transfer) {
 	lastWarning = guid ? time(NULL) : 0;
 
 	Database* db = Database::getInstance();
+	DBQuery query; // keeps the database locked for the whole transaction
 	DBTransaction trans(db);
 	if (!trans.begin()) {
 		return false;
@@ -982,6 +983,22 @@ House* Houses::getHouseByPlayer(Player* player) {
 	return NULL;
 }
 
+House* Houses::getHouseByItem(Item* item) {
+	if (!item || item->isRemoved()) {
+		return NULL;
+	}
+
+	Tile* tile = item->getTile();
+	if (!tile) {
+		return NULL;
+	}
+
+	if (HouseTile* houseTile = tile->getHouseTile()) {
+		return houseTile->getHouse();
+	}
+	return NULL;
+}
+
 House* Houses::getHouseByPlayerId(uint32_t playerId) {
 	for (HouseMap::iterator it = houseMap.begin(); it != houseMap.end(); ++it) {
 		if (!it->second->isGuild() && it->second->getOwner() == playerId) {
@@ -264,6 +264,14 @@
 				return houseTiles.size();
 			}
 
+			// items on the house tiles changed since they were last saved
+			void setDirty(bool _dirty) {
+				dirty = _dirty;
+			}
+			bool isDirty() const {
+				return dirty;
+			}
+
 			bool hasSyncFlag(syncflags_t flag) const {
 				return ((syncFlags & (uint32_t)flag) == (uint32_t)flag);
 			}
@@ -319,7 +327,7 @@
 			void removePlayer(Player* player, bool ignoreRights);
 			void removePlayers(bool ignoreInvites);
 
-			bool guild, pendingTransfer;
+			bool guild, pendingTransfer, dirty;
 			time_t paidUntil, lastWarning;
 			uint32_t id, owner, rentWarnings, rent, price, townId, size, syncFlags;
 			std::string name;
@@ -354,6 +362,7 @@
 
 			House* getHouse(uint32_t houseId, bool add = false);
 			House* getHouseByPlayer(Player* player);
+			House* getHouseByItem(Item* item);
 
 			House* getHouseByPlayerId(uint32_t playerId);
 			House* getHouseByGuildId(uint32_t guildId);
@@ -38,6 +38,7 @@ void HouseTile::__addThing(Creature* actor, int32_t index, Thing* thing) {
 
 	if (Item* item = thing->getItem()) {
 		updateHouse(item);
+		house->setDirty(true);
 	}
 }
 
@@ -52,6 +53,37 @@ void HouseTile::__internalAddThing(uint32_t index, Thing* thing) {
 	}
 }
 
+void HouseTile::__updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
+	Tile::__updateThing(thing, itemId, count);
+	house->setDirty(true);
+}
+
+void HouseTile::__replaceThing(uint32_t index, Thing* thing) {
+	Tile::__replaceThing(index, thing);
+	house->setDirty(true);
+}
+
+void HouseTile::__removeThing(Thing* thing, uint32_t count) {
+	Tile::__removeThing(thing, count);
+	if (thing->getItem()) {
+		house->setDirty(true);
+	}
+}
+
+void HouseTile::postAddNotification(Creature* actor, Thing* thing, const Cylinder* oldParent, int32_t index, cylinderlink_t link) {
+	Tile::postAddNotification(actor, thing, oldParent, index, link);
+	if (thing->getItem()) {
+		house->setDirty(true);
+	}
+}
+
+void HouseTile::postRemoveNotification(Creature* actor, Thing* thing, const Cylinder* newParent, int32_t index, bool isCompleteRemoval, cylinderlink_t link) {
+	Tile::postRemoveNotification(actor, thing, newParent, index, isCompleteRemoval, link);
+	if (thing->getItem()) {
+		house->setDirty(true);
+	}
+}
+
 void HouseTile::updateHouse(Item* item) {
 	if (item->getTile() != this) {
 		return;
@@ -34,6 +34,14 @@
 			virtual void __addThing(Creature* actor, int32_t index, Thing* thing);
 			virtual void __internalAddThing(uint32_t index, Thing* thing);
 
+			virtual void __updateThing(Thing* thing, uint16_t itemId, uint32_t count);
+			virtual void __replaceThing(uint32_t index, Thing* thing);
+			virtual void __removeThing(Thing* thing, uint32_t count);
+
+			// notifications also arrive for changes inside containers on this tile
+			virtual void postAddNotification(Creature* actor, Thing* thing, const Cylinder* oldParent, int32_t index, cylinderlink_t link = LINK_OWNER);
+			virtual void postRemoveNotification(Creature* actor, Thing* thing, const Cylinder* newParent, int32_t index, bool isCompleteRemoval, cylinderlink_t link = LINK_OWNER);
+
 			House* getHouse() {
 				return house;
 			}
@@ -34,6 +34,7 @@
 
 #include "configmanager.h"
 #include "game.h"
+#include "job.h"
 
 extern ConfigManager g_config;
 extern Game g_game;
@@ -738,6 +739,10 @@ bool IOLoginData::savePlayer(Player* player, bool preSave, bool shallow) {
 	}
 
 	Database* db = Database::getInstance();
+	if (!db->isRecording()) {
+		SaveJob::discardPlayer(player->getGUID());
+	}
+
 	DBQuery query;
 	query << "SELECT `save` FROM `players` WHERE `id` = " << player->getGUID() << " LIMIT 1";
 
@@ -30,6 +30,7 @@
 
 #include "fileloader.h"
 #include "configmanager.h"
+#include "luascript.h"
 #include "game.h"
 
 extern ConfigManager g_config;
@@ -85,7 +86,7 @@ Tile* IOMap::createTile(Item*& ground, Item* item, uint16_t px, uint16_t py, uin
 
 bool IOMap::loadMap(Map* map, const std::string& identifier) {
 	FileLoader f;
-	if (!f.openFile(identifier.c_str(), false, true)) {
+	if (!f.openFile(identifier.c_str(), false, true, true)) {
 		std::stringstream ss;
 		ss << "Could not open the file " << identifier << ".";
 		setLastErrorString(ss.str());
@@ -205,6 +206,7 @@ bool IOMap::loadMap(Map* map, const std::string& identifier) {
 		std::clog << "\"" << (*it) << "\"" << std::endl;
 	}
 
+	MapTileAreaVec areas;
 	NODE nodeMapData = f.getChildNode(nodeMap, type);
 	while (nodeMapData != NO_NODE) {
 		if (f.getError() != ERROR_NONE) {
@@ -213,222 +215,7 @@ bool IOMap::loadMap(Map* map, const std::string& identifier) {
 		}
 
 		if (type == OTBM_TILE_AREA) {
-			if (!f.getProps(nodeMapData, propStream)) {
-				setLastErrorString("Invalid map node.");
-				return false;
-			}
-
-			OTBM_Destination_coords* area_coord;
-			if (!propStream.getStruct(area_coord)) {
-				setLastErrorString("Invalid map node.");
-				return false;
-			}
-
-			int32_t base_x = area_coord->_x, base_y = area_coord->_y, base_z = area_coord->_z;
-			NODE nodeTile = f.getChildNode(nodeMapData, type);
-			while (nodeTile != NO_NODE) {
-				if (f.getError() != ERROR_NONE) {
-					setLastErrorString("Could not read node data.");
-					return false;
-				}
-
-				if (type == OTBM_TILE || type == OTBM_HOUSETILE) {
-					if (!f.getProps(nodeTile, propStream)) {
-						setLastErrorString("Could not read node data.");
-						return false;
-					}
-
-					OTBM_Tile_coords* tileCoord;
-					if (!propStream.getStruct(tileCoord)) {
-						setLastErrorString("Could not read tile position.");
-						return false;
-					}
-
-					Tile* tile = NULL;
-					Item* ground = NULL;
-					uint32_t tileflags = 0;
-
-					uint16_t px = base_x + tileCoord->_x, py = base_y + tileCoord->_y, pz = base_z;
-					House* house = NULL;
-					if (type == OTBM_HOUSETILE) {
-						uint32_t _houseid;
-						if (!propStream.getLong(_houseid)) {
-							std::stringstream ss;
-							ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Could not read house id.";
-
-							setLastErrorString(ss.str());
-							return false;
-						}
-
-						house = Houses::getInstance()->getHouse(_houseid, true);
-						if (!house) {
-							std::stringstream ss;
-							ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Could not create house id: " << _houseid;
-
-							setLastErrorString(ss.str());
-							return false;
-						}
-
-						tile = new HouseTile(px, py, pz, house);
-						house->addTile(static_cast<HouseTile*>(tile));
-					}
-
-					// read tile attributes
-					uint8_t attribute;
-					while (propStream.getByte(attribute)) {
-						switch (attribute) {
-							case OTBM_ATTR_TILE_FLAGS: {
-								uint32_t flags;
-								if (!propStream.getLong(flags)) {
-									std::stringstream ss;
-									ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Failed to read tile flags.";
-
-									setLastErrorString(ss.str());
-									return false;
-								}
-
-								if ((flags & TILESTATE_PROTECTIONZONE) == TILESTATE_PROTECTIONZONE) {
-									tileflags |= TILESTATE_PROTECTIONZONE;
-								} else if ((flags & TILESTATE_OPTIONALZONE) == TILESTATE_OPTIONALZONE) {
-									tileflags |= TILESTATE_OPTIONALZONE;
-								} else if ((flags & TILESTATE_HARDCOREZONE) == TILESTATE_HARDCOREZONE) {
-									tileflags |= TILESTATE_HARDCOREZONE;
-								}
-
-								if ((flags & TILESTATE_NOLOGOUT) == TILESTATE_NOLOGOUT) {
-									tileflags |= TILESTATE_NOLOGOUT;
-								}
-
-								if ((flags & TILESTATE_REFRESH) == TILESTATE_REFRESH) {
-									if (house) {
-										std::clog << "[x:" << px << ", y:" << py << ", z:" << pz << "] House tile flagged as refreshing!";
-									}
-									tileflags |= TILESTATE_REFRESH;
-								}
-								break;
-							}
-
-							case OTBM_ATTR_ITEM: {
-								Item* item = Item::CreateItem(propStream);
-								if (!item) {
-									std::stringstream ss;
-									ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Failed to create item.";
-
-									setLastErrorString(ss.str());
-									return false;
-								}
-
-								if (item->getItemCount() <= 0) {
-									item->setItemCount(1);
-								}
-
-								if (house && item->isMovable()) {
-									std::clog << "[Warning - IOMap::loadMap] Movable item in house: " << house->getId();
-									std::clog << ", item type: " << item->getID() << ", at position " << px << "/" << py << "/";
-									std::clog << pz << std::endl;
-
-									delete item;
-									item = NULL;
-								} else if (tile) {
-									tile->__internalAddThing(item);
-									item->__startDecaying();
-									item->setLoadedFromMap(true);
-								} else if (item->isGroundTile()) {
-									delete ground;
-
-									ground = item;
-								} else {
-									tile = createTile(ground, item, px, py, pz);
-									tile->__internalAddThing(item);
-
-									item->__startDecaying();
-									item->setLoadedFromMap(true);
-								}
-								break;
-							}
-
-							default: {
-								std::stringstream ss;
-								ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Unknown tile attribute.";
-
-								setLastErrorString(ss.str());
-								return false;
-							}
-						}
-					}
-
-					NODE nodeItem = f.getChildNode(nodeTile, type);
-					while (nodeItem) {
-						if (type == OTBM_ITEM) {
-							PropStream propStream;
-							f.getProps(nodeItem, propStream);
-
-							Item* item = Item::CreateItem(propStream);
-							if (!item) {
-								std::stringstream ss;
-								ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Failed to create item.";
-
-								setLastErrorString(ss.str());
-								return false;
-							}
-
-							if (item->unserializeItemNode(f, nodeItem, propStream)) {
-								if (item->getItemCount() <= 0) {
-									item->setItemCount(1);
-								}
-
-								if (house && item->isMovable()) {
-									std::clog << "[Warning - IOMap::loadMap] Movable item in house: ";
-									std::clog << house->getId() << ", item type: " << item->getID();
-									std::clog << ", pos " << px << "/" << py << "/" << pz << std::endl;
-
-									delete item;
-									item = NULL;
-								} else if (tile) {
-									tile->__internalAddThing(item);
-									item->__startDecaying();
-									item->setLoadedFromMap(true);
-								} else if (item->isGroundTile()) {
-									delete ground;
-
-									ground = item;
-								} else {
-									tile = createTile(ground, item, px, py, pz);
-									tile->__internalAddThing(item);
-
-									item->__startDecaying();
-									item->setLoadedFromMap(true);
-								}
-							} else {
-								std::stringstream ss;
-								ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Failed to load item " << item->getID() << ".";
-								setLastErrorString(ss.str());
-
-								delete item;
-								item = NULL;
-								return false;
-							}
-						} else {
-							std::stringstream ss;
-							ss << "[x:" << px << ", y:" << py << ", z:" << pz << "] Unknown node type.";
-							setLastErrorString(ss.str());
-						}
-
-						nodeItem = f.getNextNode(nodeItem, type);
-					}
-
-					if (!tile) {
-						tile = createTile(ground, NULL, px, py, pz);
-					}
-
-					tile->setFlag((tileflags_t)tileflags);
-					map->setTile(px, py, pz, tile);
-				} else {
-					setLastErrorString("Unknown tile node.");
-					return false;
-				}
-				nodeTile = f.getNextNode(nodeTile, type);
-			}
+			areas.push_back(MapTileArea(nodeMapData));
 		} else if (type == OTBM_TOWNS) {
 			NODE nodeTown = f.getChildNode(nodeMapData, type);
 			while (nodeTown != NO_NODE) {
@@ -504,9 +291,332 @@ bool IOMap::loadMap(Map* map, const std::string& identifier) {
 		}
 		nodeMapData = f.getNextNode(nodeMapData, type);
 	}
+	return loadTileAreas(map, f, areas);
+}
+
+bool IOMap::loadTileAreas(Map* map, FileLoader& f, MapTileAreaVec& areas) {
+	int64_t start = OTSYS_TIME();
+	uint32_t threads = g_config.getNumber(ConfigManager::MAP_LOADER_THREADS);
+	if (!threads) {
+		threads = std::max(1U, boost::thread::hardware_concurrency());
+	}
+
+	if (!f.isMapped()) {
+		threads = 1;
+	}
+
+	threads = std::min(threads, std::max(1U, (uint32_t)areas.size()));
+	ScriptEnviroment::setUniqueThingsDeferred(true);
+	// randomization draws from rand() and bed sleepers query the database,
+	// both are done in file order by commitTileArea on this thread
+	Item::items.setRandomizationDeferred(true);
+	Beds::getInstance()->setSleepersDeferred(true);
+
+	boost::thread_group workers;
+	boost::atomic<uint32_t> next(0);
+	if (threads > 1) {
+		for (uint32_t i = 0; i < threads; ++i) {
+			workers.create_thread(boost::bind(&IOMap::loadTileAreaThread, this, &f, &areas, &next));
+		}
+	}
+
+	bool result = true;
+	uint32_t tiles = 0;
+
+	ItemVector uniques;
+	for (MapTileAreaVec::iterator it = areas.begin(); it != areas.end(); ++it) {
+		if (threads > 1) {
+			boost::unique_lock<boost::mutex> areaLockUnique(m_areaLock);
+			while (!it->loaded) {
+				m_areaSignal.wait(areaLockUnique);
+			}
+		} else {
+			loadTileArea(f, *it);
+		}
+
+		tiles += it->tiles.size();
+		if (!commitTileArea(map, *it, uniques)) {
+			result = false;
+			break;
+		}
+	}
+
+	// workers may still be decoding when an area failed
+	workers.join_all();
+	Item::items.setRandomizationDeferred(false);
+	Beds::getInstance()->setSleepersDeferred(false);
+	ScriptEnviroment::setUniqueThingsDeferred(false);
+	for (ItemVector::iterator it = uniques.begin(); it != uniques.end(); ++it) {
+		ScriptEnviroment::addUniqueThing(*it);
+	}
+
+	if (result) {
+		std::clog << "> Map tiles: " << tiles << " in " << areas.size() << " areas, decoded by " << threads << " thread(s)";
+		std::clog << (f.isMapped() ? " from a memory mapped file" : "") << " in " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
+	}
+
+	return result;
+}
+
+void IOMap::loadTileAreaThread(FileLoader* f, MapTileAreaVec* areas, boost::atomic<uint32_t>* next) {
+	for (uint32_t i = (*next)++; i < areas->size(); i = (*next)++) {
+		MapTileArea& area = (*areas)[i];
+		loadTileArea(*f, area);
+
+		boost::unique_lock<boost::mutex> areaLockUnique(m_areaLock);
+		area.loaded = true;
+		m_areaSignal.notify_all();
+	}
+}
+
+static std::string tilePosition(const Position& pos) {
+	std::stringstream ss;
+	ss << "[x:" << pos.x << ", y:" << pos.y << ", z:" << pos.z << "] ";
+	return ss.str();
+}
+
+bool IOMap::loadTileArea(FileLoader& f, MapTileArea& area) const {
+	// runs on a loader thread: creates items only, everything touching
+	// the map, houses or the decay lists waits for commitTileArea
+	PropStream propStream;
+	if (!f.getProps(area.node, propStream)) {
+		area.error = "Invalid map node.";
+		return false;
+	}
+
+	OTBM_Destination_coords* area_coord;
+	if (!propStream.getStruct(area_coord)) {
+		area.error = "Invalid map node.";
+		return false;
+	}
+
+	uint32_t type = 0;
+	int32_t base_x = area_coord->_x, base_y = area_coord->_y, base_z = area_coord->_z;
+	NODE nodeTile = f.getChildNode(area.node, type);
+	while (nodeTile != NO_NODE) {
+		if (f.getError() != ERROR_NONE) {
+			area.error = "Could not read node data.";
+			return false;
+		}
+
+		if (type != OTBM_TILE && type != OTBM_HOUSETILE) {
+			area.error = "Unknown tile node.";
+			return false;
+		}
+
+		if (!f.getProps(nodeTile, propStream)) {
+			area.error = "Could not read node data.";
+			return false;
+		}
+
+		OTBM_Tile_coords* tileCoord;
+		if (!propStream.getStruct(tileCoord)) {
+			area.error = "Could not read tile position.";
+			return false;
+		}
+
+		area.tiles.push_back(MapTile());
+		MapTile& tile = area.tiles.back();
+		tile.pos = Position(base_x + tileCoord->_x, base_y + tileCoord->_y, base_z);
+
+		if (type == OTBM_HOUSETILE && !propStream.getLong(tile.houseId)) {
+			area.error = tilePosition(tile.pos) + "Could not read house id.";
+			return false;
+		}
+
+		// read tile attributes
+		uint8_t attribute;
+		while (propStream.getByte(attribute)) {
+			switch (attribute) {
+				case OTBM_ATTR_TILE_FLAGS: {
+					uint32_t flags;
+					if (!propStream.getLong(flags)) {
+						area.error = tilePosition(tile.pos) + "Failed to read tile flags.";
+						return false;
+					}
+
+					if ((flags & TILESTATE_PROTECTIONZONE) == TILESTATE_PROTECTIONZONE) {
+						tile.flags |= TILESTATE_PROTECTIONZONE;
+					} else if ((flags & TILESTATE_OPTIONALZONE) == TILESTATE_OPTIONALZONE) {
+						tile.flags |= TILESTATE_OPTIONALZONE;
+					} else if ((flags & TILESTATE_HARDCOREZONE) == TILESTATE_HARDCOREZONE) {
+						tile.flags |= TILESTATE_HARDCOREZONE;
+					}
+
+					if ((flags & TILESTATE_NOLOGOUT) == TILESTATE_NOLOGOUT) {
+						tile.flags |= TILESTATE_NOLOGOUT;
+					}
+
+					if ((flags & TILESTATE_REFRESH) == TILESTATE_REFRESH) {
+						if (tile.houseId) {
+							area.warnings.push_back(tilePosition(tile.pos) + "House tile flagged as refreshing!");
+						}
+						tile.flags |= TILESTATE_REFRESH;
+					}
+					break;
+				}
+
+				case OTBM_ATTR_ITEM: {
+					Item* item = Item::CreateItem(propStream);
+					if (!item) {
+						area.error = tilePosition(tile.pos) + "Failed to create item.";
+						return false;
+					}
+
+					loadTileItem(area, tile, item);
+					break;
+				}
+
+				default: {
+					area.error = tilePosition(tile.pos) + "Unknown tile attribute.";
+					return false;
+				}
+			}
+		}
+
+		NODE nodeItem = f.getChildNode(nodeTile, type);
+		while (nodeItem) {
+			if (type == OTBM_ITEM) {
+				PropStream propStream;
+				f.getProps(nodeItem, propStream);
+
+				Item* item = Item::CreateItem(propStream);
+				if (!item) {
+					area.error = tilePosition(tile.pos) + "Failed to create item.";
+					return false;
+				}
+
+				if (!item->unserializeItemNode(f, nodeItem, propStream)) {
+					std::stringstream error;
+					error << tilePosition(tile.pos) << "Failed to load item " << item->getID() << ".";
+					area.error = error.str();
+
+					delete item;
+					return false;
+				}
+
+				loadTileItem(area, tile, item);
+			} else {
+				area.warnings.push_back(tilePosition(tile.pos) + "Unknown node type.");
+			}
+
+			nodeItem = f.getNextNode(nodeItem, type);
+		}
+
+		nodeTile = f.getNextNode(nodeTile, type);
+	}
+	return true;
+}
+
+void IOMap::loadTileItem(MapTileArea& area, MapTile& tile, Item* item) const {
+	if (item->getItemCount() <= 0) {
+		item->setItemCount(1);
+	}
+
+	if (tile.houseId && item->isMovable()) {
+		std::stringstream ss;
+		ss << "[Warning - IOMap::loadMap] Movable item in house: " << tile.houseId << ", item type: " << item->getID();
+		ss << ", at position " << tile.pos.x << "/" << tile.pos.y << "/" << tile.pos.z;
+		area.warnings.push_back(ss.str());
+		delete item;
+	} else if (!tile.houseId && tile.items.empty() && item->isGroundTile()) {
+		// grounds replace each other until the first item creates the tile
+		delete tile.ground;
+		tile.ground = item;
+	} else {
+		tile.items.push_back(item);
+	}
+}
+
+bool IOMap::commitTileArea(Map* map, MapTileArea& area, ItemVector& uniques) {
+	for (StringVec::iterator it = area.warnings.begin(); it != area.warnings.end(); ++it) {
+		std::clog << (*it) << std::endl;
+	}
+
+	if (!area.error.empty()) {
+		setLastErrorString(area.error);
+		return false;
+	}
+
+	bool randomize = g_config.getBool(ConfigManager::RANDOMIZE_TILES);
+	for (std::vector<MapTile>::iterator it = area.tiles.begin(); it != area.tiles.end(); ++it) {
+		if (randomize && it->ground) {
+			randomizeItem(it->ground);
+		}
+
+		const Position& pos = it->pos;
+		Tile* tile = NULL;
+		if (it->houseId) {
+			House* house = Houses::getInstance()->getHouse(it->houseId, true);
+			if (!house) {
+				std::stringstream ss;
+				ss << tilePosition(pos) << "Could not create house id: " << it->houseId;
+
+				setLastErrorString(ss.str());
+				return false;
+			}
+
+			tile = new HouseTile(pos.x, pos.y, pos.z, house);
+			house->addTile(static_cast<HouseTile*>(tile));
+		} else {
+			if (it->ground && it->ground->getUniqueId()) {
+				uniques.push_back(it->ground);
+			}
+
+			// the first item on top of the ground decides between a static and dynamic tile
+			tile = createTile(it->ground, it->items.empty() ? NULL : it->items.front(), pos.x, pos.y, pos.z);
+		}
+
+		for (ItemVector::iterator iit = it->items.begin(); iit != it->items.end(); ++iit) {
+			Item* item = *iit;
+			if (randomize) {
+				randomizeItem(item);
+			}
+
+			tile->__internalAddThing(item);
+			item->__startDecaying();
+			item->setLoadedFromMap(true);
+
+			std::list<Item*> items;
+			items.push_back(item);
+			while (!items.empty()) {
+				Item* tmp = items.front();
+				items.pop_front();
+				if (randomize && tmp != item) {
+					randomizeItem(tmp);
+				}
+
+				if (tmp->getUniqueId()) {
+					uniques.push_back(tmp);
+				}
+
+				if (BedItem* bed = tmp->getBed()) {
+					bed->loadSleeper();
+				}
+
+				if (Container* container = tmp->getContainer()) {
+					for (ItemList::const_iterator cit = container->getItems(); cit != container->getEnd(); ++cit) {
+						items.push_back(*cit);
+					}
+				}
+			}
+		}
+
+		tile->setFlag((tileflags_t)it->flags);
+		map->setTile(pos.x, pos.y, pos.z, tile);
+	}
+
+	std::vector<MapTile>().swap(area.tiles);
 	return true;
 }
 
+void IOMap::randomizeItem(Item* item) const {
+	uint16_t id = Item::items.randomizeItem(item->getID());
+	if (id != item->getID()) {
+		item->setID(id);
+	}
+}
+
 bool IOMap::loadSpawns(Map* map) {
 	if (map->spawnfile.empty()) {
 		map->spawnfile = g_config.getString(ConfigManager::MAP_NAME) + "-spawn.xml";
@@ -25,6 +25,9 @@
 
 	#include "spawn.h"
 	#include "item.h"
+	#include "fileloader.h"
+
+	#include <boost/atomic.hpp>
 
 	enum OTBM_AttrTypes_t {
 		OTBM_ATTR_DESCRIPTION = 1,
@@ -94,6 +97,28 @@
 	};
 	#pragma pack()
 
+	struct MapTile {
+		MapTile(): ground(NULL), houseId(0), flags(0) {}
+
+		Position pos;
+		Item* ground;
+		ItemVector items;
+		uint32_t houseId, flags;
+	};
+
+	// a tile area decoded by a loader thread, waiting to be committed into the map
+	struct MapTileArea {
+		MapTileArea(NODE _node): node(_node), loaded(false) {}
+
+		NODE node;
+		bool loaded;
+
+		std::vector<MapTile> tiles;
+		StringVec warnings;
+		std::string error;
+	};
+	typedef std::vector<MapTileArea> MapTileAreaVec;
+
 	class IOMap {
 		public:
 			IOMap() {}
@@ -122,6 +147,19 @@
 			}
 
 		protected:
+			// tile areas are decoded in parallel when the file could be mapped,
+			// but committed into the map in file order from the loading thread
+			bool loadTileAreas(Map* map, FileLoader& f, MapTileAreaVec& areas);
+			void loadTileAreaThread(FileLoader* f, MapTileAreaVec* areas, boost::atomic<uint32_t>* next);
+
+			bool loadTileArea(FileLoader& f, MapTileArea& area) const;
+			void loadTileItem(MapTileArea& area, MapTile& tile, Item* item) const;
+			bool commitTileArea(Map* map, MapTileArea& area, ItemVector& uniques);
+			void randomizeItem(Item* item) const;
+
 			std::string errorString;
+
+			boost::mutex m_areaLock;
+			boost::condition_variable m_areaSignal;
 	};
 #endif
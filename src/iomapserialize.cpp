@@ -22,6 +22,7 @@
 #include "iologindata.h"
 
 #include "configmanager.h"
+#include "scheduler.h"
 #include "game.h"
 
 extern ConfigManager g_config;
@@ -51,11 +52,57 @@ bool IOMapSerialize::loadMap(Map* map) {
 	return true;
 }
 
-bool IOMapSerialize::saveMap(Map* map) {
+bool IOMapSerialize::saveMap(Map*) {
+	bool success = true;
+	HouseDataList list;
+
+	std::vector<House*> saved;
+	for (HouseMap::iterator it = Houses::getInstance()->getHouseBegin(); it != Houses::getInstance()->getHouseEnd(); ++it) {
+		House* house = it->second;
+		if (!house->isDirty()) {
+			continue;
+		}
+
+		if (HouseData* data = saveHouseData(house)) {
+			list.push_back(data);
+			saved.push_back(house);
+		} else {
+			std::clog << "[Warning - IOMapSerialize::saveMap] Could not save house " << house->getName() << " (" << house->getId() << ")." << std::endl;
+			success = false;
+		}
+	}
+
+	// a house that failed above keeps its flag and is tried again with the next save
+	addHouseData(list);
+	for (std::vector<House*>::iterator it = saved.begin(); it != saved.end(); ++it) {
+		(*it)->setDirty(false);
+	}
+	return success;
+}
+
+bool IOMapSerialize::saveHouseItems(House* house) {
+	if (!house->isDirty()) {
+		return true;
+	}
+
+	HouseData* data = saveHouseData(house);
+	if (!data) {
+		return false;
+	}
+
+	HouseDataList list;
+	list.push_back(data);
+	addHouseData(list);
+
+	house->setDirty(false);
+	return true;
+}
+
+HouseData* IOMapSerialize::saveHouseData(House* house) {
 	if (g_config.getBool(ConfigManager::HOUSE_STORAGE)) {
-		return saveMapBinary(map);
+		return saveHouseBinary(house);
 	}
-	return saveMapRelational(map);
+	return saveHouseRelational(house);
 }
 
 bool IOMapSerialize::updateAuctions() {
@@ -197,19 +244,6 @@ bool IOMapSerialize::updateHouses() {
 	return true;
 }
 
-bool IOMapSerialize::saveHouses() {
-	Database* db = Database::getInstance();
-	DBTransaction trans(db);
-	if (!trans.begin()) {
-		return false;
-	}
-
-	for (HouseMap::iterator it = Houses::getInstance()->getHouseBegin(); it != Houses::getInstance()->getHouseEnd(); ++it) {
-		saveHouse(db, it->second);
-	}
-	return trans.commit();
-}
-
 bool IOMapSerialize::saveHouse(Database* db, House* house) {
 	DBQuery query;
 	query << "UPDATE `houses` SET `owner` = " << house->getOwner() << ", `paid` = " << house->getPaidUntil() << ", `warnings` = " << house->getRentWarnings() << ", `lastwarning` = " << house->getLastWarning() << ", `clear` = 0 WHERE `id` = " << house->getId() << " AND `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID) << db->getUpdateLimiter();
@@ -278,6 +312,7 @@ bool IOMapSerialize::loadMapRelational(Map* map) {
 				query << "SELECT * FROM `tile_items` WHERE `tile_id` = " << result->getDataInt("id") << " AND `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID) << " ORDER BY `sid` DESC";
 				if (DBResult* itemsResult = db->storeQuery(query.str())) {
 					if (house->hasPendingTransfer()) {
+						house->setDirty(true);
 						if (Player* player = g_game.getPlayerByGuidEx(house->getOwner())) {
 							Depot* depot = player->getDepot(house->getTownId(), true);
 							loadItems(db, itemsResult, depot, true);
@@ -292,6 +327,7 @@ bool IOMapSerialize::loadMapRelational(Map* map) {
 							loadItems(db, itemsResult, tile, false);
 						} else {
 							std::clog << "[Error - IOMapSerialize::loadMapRelational] Unserialization" << " of invalid tile at position "<< pos << std::endl;
+							house->setDirty(true);
 						}
 					}
 					itemsResult->free();
@@ -306,6 +342,7 @@ bool IOMapSerialize::loadMapRelational(Map* map) {
 					query.str("");
 					query << "SELECT * FROM `tile_items` WHERE `tile_id` = " << result->getDataInt("id") << " AND `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID) << " ORDER BY `sid` DESC";
 					if (DBResult* itemsResult = db->storeQuery(query.str())) {
+						house->setDirty(true); // stored by position only, save it with tile ids
 						if (house->hasPendingTransfer()) {
 							if (Player* player = g_game.getPlayerByGuidEx(house->getOwner())) {
 								Depot* depot = player->getDepot(house->getTownId(), true);
@@ -328,36 +365,12 @@ bool IOMapSerialize::loadMapRelational(Map* map) {
 	return true;
 }
 
-bool IOMapSerialize::saveMapRelational(Map*) {
-	Database* db = Database::getInstance();
-	// Start the transaction
-	DBTransaction trans(db);
-	if (!trans.begin()) {
-		return false;
+HouseData* IOMapSerialize::saveHouseRelational(House* house) {
+	HouseData* data = new HouseData(house->getId());
+	for (HouseTileList::iterator it = house->getHouseTileBegin(); it != house->getHouseTileEnd(); ++it) {
+		saveItems(data, (*it));
 	}
-
-	// clear old tile data
-	DBQuery query;
-	query << "DELETE FROM `tile_items` WHERE `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID);
-	if (!db->query(query.str())) {
-		return false;
-	}
-
-	query.str("");
-	query << "DELETE FROM `tiles` WHERE `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID);
-	if (!db->query(query.str())) {
-		return false;
-	}
-
-	uint32_t tileId = 0;
-	for (HouseMap::iterator it = Houses::getInstance()->getHouseBegin(); it != Houses::getInstance()->getHouseEnd(); ++it) {
-		// save house items
-		for (HouseTileList::iterator tit = it->second->getHouseTileBegin(); tit != it->second->getHouseTileEnd(); ++tit) {
-			saveItems(db, tileId, it->second->getId(), (*tit));
-		}
-	}
-	// End the transaction
-	return trans.commit();
+	return data;
 }
 
 bool IOMapSerialize::loadMapBinary(Map* map) {
@@ -393,6 +406,7 @@ bool IOMapSerialize::loadMapBinary(Map* map) {
 
 			Position pos(x, y, (int16_t)z);
 			if (house && house->hasPendingTransfer()) {
+				house->setDirty(true);
 				if (Player* player = g_game.getPlayerByGuidEx(house->getOwner())) {
 					Depot* depot = player->getDepot(player->getTown(), true);
 					while (itemCount--) {
@@ -410,6 +424,9 @@ bool IOMapSerialize::loadMapBinary(Map* map) {
 				}
 			} else {
 				std::clog << "[Error - IOMapSerialize::loadMapBinary] Unserialization of invalid tile" << " at position " << pos << std::endl;
+				if (house) {
+					house->setDirty(true);
+				}
 				break;
 			}
 		}
@@ -418,48 +435,162 @@ bool IOMapSerialize::loadMapBinary(Map* map) {
 	return true;
 }
 
-bool IOMapSerialize::saveMapBinary(Map*) {
+HouseData* IOMapSerialize::saveHouseBinary(House* house) {
+	boost::shared_ptr<PropWriteStream> stream(new PropWriteStream());
+	for (HouseTileList::iterator it = house->getHouseTileBegin(); it != house->getHouseTileEnd(); ++it) {
+		if (!saveTile(*stream, *it)) {
+			return NULL;
+		}
+	}
+
+	HouseData* data = new HouseData(house->getId());
+	data->data = stream;
+	return data;
+}
+
+void IOMapSerialize::flush() {
+	boost::unique_lock<boost::mutex> writerLockUnique(m_writerLock);
+	while (!m_writerQueue.empty()) {
+		m_writerSignal.wait(writerLockUnique);
+	}
+}
+
+void IOMapSerialize::addHouseData(HouseDataList& list) {
+	if (list.empty()) {
+		return;
+	}
+
+	if (!m_writerStarted) {
+		m_writerStarted = true;
+		boost::thread(boost::bind(&IOMapSerialize::writerThread, this));
+	}
+
+	m_writerLock.lock();
+	m_writerQueue.splice(m_writerQueue.end(), list);
+	m_writerLock.unlock();
+	m_writerSignal.notify_all();
+}
+
+void IOMapSerialize::writerThread() {
 	Database* db = Database::getInstance();
-	// Start the transaction
+	boost::unique_lock<boost::mutex> writerLockUnique(m_writerLock, boost::defer_lock);
+	while (true) {
+		writerLockUnique.lock();
+		while (m_writerQueue.empty()) {
+			m_writerSignal.wait(writerLockUnique);
+		}
+
+		// stays queued until it is written, so flush waits for it
+		HouseData* data = m_writerQueue.front();
+		writerLockUnique.unlock();
+
+		bool saved = false;
+		if (data->data) {
+			saved = writeHouseBinary(db, data);
+		} else {
+			saved = writeHouseRelational(db, data);
+		}
+
+		if (!saved) {
+			std::clog << "[Error - IOMapSerialize::writerThread] Could not save house " << data->houseId << ", it will be saved again with the next save." << std::endl;
+			Dispatcher::getInstance().addTask(createTask(boost::bind(&IOMapSerialize::setHouseDirty, this, data->houseId)));
+		}
+
+		writerLockUnique.lock();
+		m_writerQueue.pop_front();
+		writerLockUnique.unlock();
+
+		delete data;
+		m_writerSignal.notify_all();
+	}
+}
+
+bool IOMapSerialize::writeHouseBinary(Database* db, const HouseData* data) {
+	DBQuery query; // keeps the database locked for the whole transaction
 	DBTransaction transaction(db);
 	if (!transaction.begin()) {
 		return false;
+	}
 
+	query << "DELETE FROM `house_data` WHERE `house_id` = " << data->houseId << " AND `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID);
+	if (!db->query(query.str())) {
+		return false;
 	}
 
-	DBQuery query;
-	query << "DELETE FROM `house_data` WHERE `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID);
+	uint32_t attributesSize = 0;
+	const char* attributes = data->data->getStream(attributesSize);
+
+	query.str("");
+	query << "INSERT INTO `house_data` (`house_id`, `world_id`, `data`) VALUES (" << data->houseId << ", " << g_config.getNumber(ConfigManager::WORLD_ID) << ", " << db->escapeBlob(attributes, attributesSize) << ")";
 	if (!db->query(query.str())) {
 		return false;
 	}
+	return transaction.commit();
+}
 
-	DBInsert stmt(db);
-	stmt.setQuery("INSERT INTO `house_data` (`house_id`, `world_id`, `data`) VALUES ");
-	for (HouseMap::iterator it = Houses::getInstance()->getHouseBegin(); it != Houses::getInstance()->getHouseEnd(); ++it) {
-		// save house items
-		PropWriteStream stream;
-		for (HouseTileList::iterator tit = it->second->getHouseTileBegin(); tit != it->second->getHouseTileEnd(); ++tit) {
-			if (!saveTile(stream, *tit)) {
-				return false;
-			}
+bool IOMapSerialize::writeHouseRelational(Database* db, const HouseData* data) {
+	DBQuery query; // keeps the database locked for the whole transaction
+	DBTransaction transaction(db);
+	if (!transaction.begin()) {
+		return false;
+	}
+
+	query << "DELETE FROM `tile_items` WHERE `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID) << " AND `tile_id` IN (SELECT `id` FROM `tiles` WHERE `house_id` = " << data->houseId << " AND `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID) << ")";
+	if (!db->query(query.str())) {
+		return false;
+	}
+
+	query.str("");
+	query << "DELETE FROM `tiles` WHERE `house_id` = " << data->houseId << " AND `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID);
+	if (!db->query(query.str())) {
+		return false;
+	}
+
+	if (!m_nextTileId) {
+		// tile ids are no longer rewritten from zero, continue after the highest one
+		query.str("");
+		query << "SELECT MAX(`id`) AS `id` FROM `tiles` WHERE `world_id` = " << g_config.getNumber(ConfigManager::WORLD_ID);
+		if (DBResult* result = db->storeQuery(query.str())) {
+			m_nextTileId = result->getDataInt("id");
+			result->free();
 		}
 
-		uint32_t attributesSize = 0;
-		const char* attributes = stream.getStream(attributesSize);
+		++m_nextTileId;
+	}
+
+	for (std::vector<HouseTileRows>::const_iterator it = data->tiles.begin(); it != data->tiles.end(); ++it) {
+		uint32_t tileId = m_nextTileId++;
+
 		query.str("");
+		query << "INSERT INTO `tiles` (`id`, `world_id`, `house_id`, `x`, `y`, `z`) VALUES (" << tileId << ", " << g_config.getNumber(ConfigManager::WORLD_ID) << ", " << data->houseId << ", " << it->pos.x << ", " << it->pos.y << ", " << it->pos.z << ")";
+		if (!db->query(query.str())) {
+			return false;
+		}
+
+		DBInsert query_insert(db);
+		query_insert.setQuery("INSERT INTO `tile_items` (`tile_id`, `world_id`, `sid`, `pid`, `itemtype`, `count`, `attributes`) VALUES ");
+		for (std::vector<HouseItemRow>::const_iterator iit = it->items.begin(); iit != it->items.end(); ++iit) {
+			uint32_t attributesSize = 0;
+			const char* attributes = iit->attributes->getStream(attributesSize);
+
+			query.str("");
+			query << tileId << ", " << g_config.getNumber(ConfigManager::WORLD_ID) << ", " << iit->sid << ", " << iit->pid << ", " << iit->type << ", " << iit->count << ", " << db->escapeBlob(attributes, attributesSize);
+			if (!query_insert.addRow(query.str())) {
+				return false;
+			}
+		}
 
-		query << it->second->getId() << ", " << g_config.getNumber(ConfigManager::WORLD_ID) << ", " << db->escapeBlob(attributes, attributesSize);
-		if (!stmt.addRow(query)) {
+		if (!query_insert.execute()) {
 			return false;
 		}
 	}
+	return transaction.commit();
+}
 
-	query.str("");
-	if (!stmt.execute()) {
-		return false;
+void IOMapSerialize::setHouseDirty(uint32_t houseId) {
+	if (House* house = Houses::getInstance()->getHouse(houseId)) {
+		house->setDirty(true);
 	}
-	// End the transaction
-	return transaction.commit();
 }
 
 bool IOMapSerialize::loadItems(Database*, DBResult* result, Cylinder* parent, bool depotTransfer) {
@@ -563,49 +694,39 @@ bool IOMapSerialize::loadItems(Database*, DBResult* result, Cylinder* parent, bo
 	return true;
 }
 
-bool IOMapSerialize::saveItems(Database* db, uint32_t& tileId, uint32_t houseId, const Tile* tile) {
+void IOMapSerialize::saveItems(HouseData* data, const Tile* tile) {
 	int32_t thingCount = tile->getThingCount();
 	if (!thingCount) {
-		return true;
+		return;
 	}
 
 	Item* item = NULL;
 	int32_t runningId = 0, parentId = 0;
 	ContainerStackList containerStackList;
 
-	bool stored = false;
-	DBInsert query_insert(db);
-	query_insert.setQuery("INSERT INTO `tile_items` (`tile_id`, `world_id`, `sid`, `pid`, `itemtype`, `count`, `attributes`) VALUES ");
-
-	DBQuery query;
+	HouseTileRows* rows = NULL;
 	for (int32_t i = 0; i < thingCount; ++i) {
 		if (!(item = tile->__getThing(i)->getItem()) || (!item->isMovable() && !item->forceSerialize())) {
 			continue;
 		}
 
-		if (!stored) {
-			Position tilePosition = tile->getPosition();
-			query << "INSERT INTO `tiles` (`id`, `world_id`, `house_id`, `x`, `y`, `z`) VALUES (" << tileId << ", " << g_config.getNumber(ConfigManager::WORLD_ID) << ", " << houseId << ", " << tilePosition.x << ", " << tilePosition.y << ", " << tilePosition.z << ")";
-			if (!db->query(query.str())) {
-				return false;
-			}
-
-			stored = true;
-			query.str("");
+		if (!rows) {
+			data->tiles.push_back(HouseTileRows());
+			rows = &data->tiles.back();
+			rows->pos = tile->getPosition();
 		}
 
-		PropWriteStream propWriteStream;
-		item->serializeAttr(propWriteStream);
+		boost::shared_ptr<PropWriteStream> propWriteStream(new PropWriteStream());
+		item->serializeAttr(*propWriteStream);
 
-		uint32_t attributesSize = 0;
-		const char* attributes = propWriteStream.getStream(attributesSize);
+		HouseItemRow row;
+		row.sid = ++runningId;
+		row.pid = parentId;
+		row.type = item->getID();
+		row.count = (int32_t)item->getSubType();
+		row.attributes = propWriteStream;
+		rows->items.push_back(row);
 
-		query << tileId << ", " << g_config.getNumber(ConfigManager::WORLD_ID) << ", " << ++runningId << ", " << parentId << ", " << item->getID() << ", " << (int32_t)item->getSubType() << ", " << db->escapeBlob(attributes, attributesSize);
-		if (!query_insert.addRow(query.str())) {
-			return false;
-		}
-
-		query.str("");
 		if (item->getContainer()) {
 			containerStackList.push_back(std::make_pair(item->getContainer(), runningId));
 		}
@@ -620,28 +741,22 @@ bool IOMapSerialize::saveItems(Database* db, uint32_t& tileId, uint32_t houseId,
 				continue;
 			}
 
-			PropWriteStream propWriteStream;
-			item->serializeAttr(propWriteStream);
+			boost::shared_ptr<PropWriteStream> propWriteStream(new PropWriteStream());
+			item->serializeAttr(*propWriteStream);
 
-			uint32_t attributesSize = 0;
-			const char* attributes = propWriteStream.getStream(attributesSize);
-
-			query << tileId << ", " << g_config.getNumber(ConfigManager::WORLD_ID) << ", " << ++runningId << ", " << parentId << ", " << item->getID() << ", " << (int32_t)item->getSubType() << ", " << db->escapeBlob(attributes, attributesSize);
-			if (!query_insert.addRow(query.str())) {
-				return false;
-			}
+			HouseItemRow row;
+			row.sid = ++runningId;
+			row.pid = parentId;
+			row.type = item->getID();
+			row.count = (int32_t)item->getSubType();
+			row.attributes = propWriteStream;
+			rows->items.push_back(row);
 
-			query.str("");
 			if (item->getContainer()) {
 				containerStackList.push_back(std::make_pair(item->getContainer(), runningId));
 			}
 		}
 	}
-
-	if (stored) {
-		++tileId;
-	}
-	return query_insert.execute();
 }
 
 bool IOMapSerialize::loadContainer(PropStream& propStream, Container* container) {
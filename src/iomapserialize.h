@@ -21,11 +21,33 @@
 	#include "otsystem.h"
 
 	#include "database.h"
+	#include "fileloader.h"
 	#include "map.h"
 
 	typedef std::map<int32_t, std::pair<Item*, int32_t> > ItemMap;
 	typedef std::list<std::pair<Container*, int32_t> > ContainerStackList;
 
+	typedef boost::shared_ptr<const PropWriteStream> PropWriteStream_ptr;
+	struct HouseItemRow {
+		int32_t sid, pid, type, count;
+		PropWriteStream_ptr attributes;
+	};
+
+	struct HouseTileRows {
+		Position pos;
+		std::vector<HouseItemRow> items;
+	};
+
+	// a snapshot of one house taken on the game thread, written by the writer thread
+	struct HouseData {
+		HouseData(uint32_t _houseId): houseId(_houseId) {}
+
+		uint32_t houseId;
+		PropWriteStream_ptr data; // binary storage
+		std::vector<HouseTileRows> tiles; // relational storage
+	};
+	typedef std::list<HouseData*> HouseDataList;
+
 	class House;
 	class IOMapSerialize {
 		public:
@@ -42,28 +64,49 @@
 
 			bool loadHouses();
 			bool updateHouses();
-			bool saveHouses();
 
 			bool saveHouse(Database* db, House* house);
+			// snapshots the items of a single house, if it changed, and queues them for the writer
+			bool saveHouseItems(House* house);
+
+			// blocks until the writer thread stored everything queued so far
+			void flush();
 
 		protected:
-			IOMapSerialize() {}
+			IOMapSerialize(): m_writerStarted(false), m_nextTileId(0) {}
+
+			HouseData* saveHouseData(House* house);
 
 			// Relational storage uses a row for each item/tile
 			bool loadMapRelational(Map* map);
-			bool saveMapRelational(Map* map);
+			HouseData* saveHouseRelational(House* house);
 
 			// Binary storage uses a giant BLOB field for storing everything
 			bool loadMapBinary(Map* map);
-			bool saveMapBinary(Map* map);
+			HouseData* saveHouseBinary(House* house);
 
 			bool loadItems(Database* db, DBResult* result, Cylinder* parent, bool depotTransfer);
-			bool saveItems(Database* db, uint32_t& tileId, uint32_t houseId, const Tile* tile);
+			void saveItems(HouseData* data, const Tile* tile);
 
 			bool loadContainer(PropStream& propStream, Container* container);
 			bool loadItem(PropStream& propStream, Cylinder* parent, bool depotTransfer);
 
 			bool saveTile(PropWriteStream& stream, const Tile* tile);
 			bool saveItem(PropWriteStream& stream, const Item* item);
+
+			// only houses changed since the last save are written, one transaction each
+			void addHouseData(HouseDataList& list);
+			void writerThread();
+
+			bool writeHouseRelational(Database* db, const HouseData* data);
+			bool writeHouseBinary(Database* db, const HouseData* data);
+			void setHouseDirty(uint32_t houseId);
+
+			bool m_writerStarted;
+			uint32_t m_nextTileId;
+
+			boost::mutex m_writerLock;
+			boost::condition_variable m_writerSignal;
+			HouseDataList m_writerQueue;
 	};
 #endif
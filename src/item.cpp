@@ -42,6 +42,10 @@ extern Game g_game;
 extern ConfigManager g_config;
 extern MoveEvents* g_moveEvents;
 
+#ifdef __OTSERV_ALLOCATOR__
+	DEFINE_SLAB_ALLOCATOR(Item, "item", sizeof(Item))
+#endif
+
 Items Item::items;
 Item* Item::CreateItem(const uint16_t type, uint16_t amount) {
 	const ItemType& it = Item::items[type];
@@ -178,6 +182,7 @@ bool Item::loadContainer(xmlNodePtr parentNode, Container* parent) {
 Item::Item(const uint16_t type, uint16_t amount):ItemAttributes(), id(type) {
 	raid = NULL;
 	loadedFromMap = false;
+	decayEntry = NULL;
 
 	setItemCount(1);
 	setDefaultDuration();
@@ -219,6 +224,13 @@ void Item::copyAttributes(Item* item) {
 	eraseAttribute("duration");
 }
 
+void Item::setDuration(int32_t time) {
+	setAttribute("duration", time);
+	if (decayEntry) {
+		g_game.updateDecay(this, time);
+	}
+}
+
 void Item::onRemoved() {
 	if (raid) {
 		raid->unRef();
@@ -242,8 +254,11 @@ void Item::setDefaultSubtype() {
 void Item::setID(uint16_t newId) {
 	const ItemType& it = Item::items[newId];
 	const ItemType& pit = Item::items[id];
-	id = newId;
+	if (decayEntry && (it.decayTo < 0 || !it.decayTime)) { // the new type never decays, take it off the wheel
+		g_game.stopDecay(this);
+	}
 
+	id = newId;
 	uint32_t newDuration = it.decayTime * 1000;
 	if (!newDuration && !it.stopTime && it.decayTo == -1) {
 		eraseAttribute("decaying");
@@ -651,6 +666,11 @@ bool Item::serializeAttr(PropWriteStream& propWriteStream) const {
 		propWriteStream.addByte(ATTR_ATTRIBUTE_MAP);
 		serializeMap(propWriteStream);
 	}
+
+	if (decayEntry) { // overrides the stale value stored in the map
+		propWriteStream.addByte(ATTR_DURATION);
+		propWriteStream.addLong((uint32_t)getDuration());
+	}
 	return true;
 }
 
@@ -29,6 +29,12 @@
 	#include "items.h"
 	#include "raids.h"
 
+	#ifdef __OTSERV_ALLOCATOR__
+		#include "allocator.h"
+	#endif
+
+	#include "decay.h"
+
 	class Creature;
 	class Player;
 
@@ -130,6 +136,10 @@
 
 	class Item : virtual public Thing, public ItemAttributes {
 		public:
+			#ifdef __OTSERV_ALLOCATOR__
+				DECLARE_SLAB_ALLOCATOR()
+			#endif
+
 			static Items items;
 
 			// Factory member to create item of right type based on type
@@ -142,7 +152,7 @@
 			// Constructor for items
 			Item(const uint16_t type, uint16_t amount = 0);
 			Item(const Item &i):
-				Thing(), ItemAttributes(i), id(i.id), count(i.count) {}
+				Thing(), ItemAttributes(i), id(i.id), count(i.count), decayEntry(NULL) {}
 			virtual ~Item() {}
 
 			virtual Item* clone() const;
@@ -238,10 +248,7 @@
 			}
 
 			// Item attributes
-			void setDuration(int32_t time) {
-				setAttribute("duration", time);
-			}
-			void decreaseDuration(int32_t time);
+			void setDuration(int32_t time);
 			int32_t getDuration() const;
 
 			void setSpecialDescription(const std::string& description) {
@@ -307,6 +314,9 @@
 				setAttribute("decaying", (int32_t)state);
 			}
 			ItemDecayState_t getDecaying() const;
+			bool isDecayScheduled() const {
+				return decayEntry != NULL;
+			}
 
 			std::string getName() const;
 			std::string getPluralName() const;
@@ -498,6 +508,9 @@
 
 			Raid* raid;
 			bool loadedFromMap;
+
+			DecayEntry* decayEntry;
+			friend class DecayWheel;
 	};
 
 	inline std::string Item::getName() const {
@@ -604,14 +617,11 @@
 		return items[id].dualWield;
 	}
 
-	inline void Item::decreaseDuration(int32_t time) {
-		const int32_t* v = getIntegerAttribute("duration");
-		if (v) {
-			setAttribute("duration", *v - time);
+	inline int32_t Item::getDuration() const {
+		if (decayEntry) { // the attribute is only brought up to date when the item leaves the wheel
+			return (int32_t)std::max((int64_t)0, decayEntry->expiry - OTSYS_TIME());
 		}
-	}
 
-	inline int32_t Item::getDuration() const {
 		const int32_t* v = getIntegerAttribute("duration");
 		if (v) {
 			return *v;
@@ -1509,10 +1509,13 @@ void Items::parseRandomizationBlock(int32_t id, int32_t fromId, int32_t toId, in
 }
 
 uint16_t Items::getRandomizedItem(uint16_t id) {
-	if (!g_config.getBool(ConfigManager::RANDOMIZE_TILES)) {
+	if (m_randomizationDeferred || !g_config.getBool(ConfigManager::RANDOMIZE_TILES)) {
 		return id;
 	}
+	return randomizeItem(id);
+}
 
+uint16_t Items::randomizeItem(uint16_t id) {
 	RandomizationBlock randomize = getRandomization(id);
 	if (randomize.chance > 0 && random_range(0, 100) <= randomize.chance) {
 		id = random_range(randomize.fromRange, randomize.toRange);
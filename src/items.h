@@ -250,7 +250,7 @@
 	class Items {
 		public:
 			Items():
-				m_randomizationChance(RANDOMIZATION), items(ITEMS) {}
+				m_randomizationChance(RANDOMIZATION), m_randomizationDeferred(false), items(ITEMS) {}
 			virtual ~Items() {
 				clear();
 			}
@@ -271,6 +271,12 @@
 			const ItemType& getItemIdByClientId(int32_t spriteId) const;
 
 			uint16_t getRandomizedItem(uint16_t id);
+			uint16_t randomizeItem(uint16_t id);
+			// while the map loader threads decode, items are created as stored and
+			// the loading thread randomizes them once their tile is committed
+			void setRandomizationDeferred(bool deferred) {
+				m_randomizationDeferred = deferred;
+			}
 			uint8_t getRandomizationChance() const {
 				return m_randomizationChance;
 			}
@@ -294,6 +300,7 @@
 
 		private:
 			uint8_t m_randomizationChance;
+			bool m_randomizationDeferred;
 			void clear();
 
 			void parseRandomizationBlock(int32_t id, int32_t fromId, int32_t toId, int32_t chance);
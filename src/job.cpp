@@ -0,0 +1,267 @@
+/*
+* OpenTibia - an opensource roleplaying game.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "otpch.h"
+#include "job.h"
+#include "tools.h"
+
+#include "iologindata.h"
+#include "iomapserialize.h"
+#include "house.h"
+
+#include "configmanager.h"
+#include "luascript.h"
+#include "scheduler.h"
+
+extern ConfigManager g_config;
+extern Game g_game;
+
+bool Jobs::add(Job* job) {
+	if (isRunning(job->getName())) {
+		std::clog << "[Warning - Jobs::add] A " << job->getName() << " is already in progress." << std::endl;
+		delete job;
+		return false;
+	}
+
+	m_jobs.push_back(job);
+	job->m_start = job->m_lastReport = OTSYS_TIME();
+	job->start();
+
+	Dispatcher::getInstance().addTask(createTask(boost::bind(&Jobs::tick, this, job)));
+	return true;
+}
+
+void Jobs::run(Job& job) {
+	job.m_start = job.m_lastReport = OTSYS_TIME();
+	job.m_ticks = 1;
+
+	job.start();
+	while (job.step()) {}
+	job.finish();
+}
+
+bool Jobs::isRunning(const std::string& name) const {
+	for (JobList::const_iterator it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+		if ((*it)->getName() == name) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Jobs::tick(Job* job) {
+	++job->m_ticks;
+	int64_t now = OTSYS_TIME(), deadline = now + std::max((int32_t)1, g_config.getNumber(ConfigManager::MAINTENANCE_TICK_BUDGET));
+	while (now < deadline) {
+		if (!job->step()) {
+			job->finish();
+			m_jobs.remove(job);
+
+			delete job;
+			return;
+		}
+
+		now = OTSYS_TIME();
+	}
+
+	if (now - job->m_lastReport >= JOB_REPORT_INTERVAL) {
+		job->m_lastReport = now;
+		std::clog << "> " << asUpperCaseString(job->getName()) << ": " << job->getDone() << "/" << job->getTotal();
+		if (job->getTotal()) {
+			std::clog << " (" << (uint64_t)job->getDone() * 100 / job->getTotal() << "%)";
+		}
+
+		std::clog << " done after " << job->getDuration() / (1000.) << " seconds." << std::endl;
+	}
+
+	Scheduler::getInstance().addEvent(createSchedulerTask(SCHEDULER_MINTICKS, boost::bind(&Jobs::tick, this, job)));
+}
+
+void SaveJob::start() {
+	std::clog << "> Saving server..." << std::endl;
+	Database* db = Database::getInstance();
+	IOMapSerialize* io = IOMapSerialize::getInstance();
+
+	DBQuery query; // nothing else may run a query while statements are recorded
+	DBStatementList statements;
+	db->setRecorder(&statements);
+	for (AutoList<Player>::iterator it = Player::autoList.begin(); it != Player::autoList.end(); ++it) {
+		Player* player = it->second;
+		player->loginPosition = player->getPosition();
+		if (IOLoginData::getInstance()->savePlayer(player, false, m_shallow)) {
+			addBatch("player " + player->getName(), player->getGUID(), statements);
+		} else {
+			std::clog << "[Warning - SaveJob::start] Could not save player " << player->getName() << "." << std::endl;
+			statements.clear();
+		}
+	}
+
+	for (HouseMap::iterator it = Houses::getInstance()->getHouseBegin(); it != Houses::getInstance()->getHouseEnd(); ++it) {
+		if (io->saveHouse(db, it->second)) {
+			addBatch("house " + it->second->getName(), 0, statements);
+		} else {
+			std::clog << "[Warning - SaveJob::start] Could not save house " << it->second->getName() << " (" << it->second->getId() << ")." << std::endl;
+			statements.clear();
+		}
+	}
+
+	if (ScriptEnviroment::saveGameState()) {
+		addBatch("global storage", 0, statements);
+	} else {
+		std::clog << "[Warning - SaveJob::start] Could not save global storage." << std::endl;
+		statements.clear();
+	}
+
+	db->setRecorder(NULL);
+	// house items go straight to the writer thread
+	io->saveMap(g_game.getMap());
+	m_total = m_batches.size();
+}
+
+bool SaveJob::step() {
+	if (m_batches.empty()) {
+		return false;
+	}
+
+	SaveBatch& batch = m_batches.front();
+	Database* db = Database::getInstance();
+
+	DBQuery query; // keeps the database locked for the whole transaction
+	DBTransaction trans(db);
+
+	bool success = trans.begin();
+	for (DBStatementList::const_iterator it = batch.statements.begin(); success && it != batch.statements.end(); ++it) {
+		success = db->query(*it);
+	}
+
+	if (!success || !trans.commit()) {
+		std::clog << "[Warning - SaveJob::step] Could not save " << batch.name << "." << std::endl;
+	}
+
+	if (batch.guid) {
+		m_playerBatches.erase(batch.guid);
+	}
+
+	m_batches.pop_front();
+	++m_done;
+	return true;
+}
+
+void SaveJob::addBatch(const std::string& name, uint32_t guid, DBStatementList& statements) {
+	if (statements.empty()) {
+		return;
+	}
+
+	m_batches.push_back(SaveBatch());
+	m_batches.back().name = name;
+	m_batches.back().guid = guid;
+	m_batches.back().statements.swap(statements);
+	if (guid) {
+		m_playerBatches[guid] = --m_batches.end();
+	}
+}
+
+void SaveJob::discardPlayer(uint32_t guid) {
+	const JobList& jobs = Jobs::getInstance()->getJobs();
+	for (JobList::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
+		SaveJob* job = dynamic_cast<SaveJob*>(*it);
+		if (!job) {
+			continue;
+		}
+
+		std::map<uint32_t, SaveBatchList::iterator>::iterator bit = job->m_playerBatches.find(guid);
+		if (bit == job->m_playerBatches.end()) {
+			continue;
+		}
+
+		job->m_batches.erase(bit->second);
+		job->m_playerBatches.erase(bit);
+		++job->m_done;
+	}
+}
+
+void SaveJob::finish() {
+	std::clog << "> SAVE: Complete in " << getDuration() / (1000.) << " seconds using ";
+	std::clog << (g_config.getBool(ConfigManager::HOUSE_STORAGE) ? "binary" : "relational") << " house storage";
+	if (getTicks() > 1) {
+		std::clog << " over " << getTicks() << " cycles";
+	}
+
+	std::clog << "." << std::endl;
+}
+
+void CleanJob::start() {
+	const Trash& trash = g_game.getTrash();
+	m_list.assign(trash.begin(), trash.end());
+	m_total = m_list.size();
+}
+
+bool CleanJob::step() {
+	if (m_next >= m_list.size()) {
+		return false;
+	}
+
+	Tile* tile = m_list[m_next++];
+	if (tile->hasFlag(TILESTATE_TRASHED)) {
+		if (uint32_t removed = g_game.cleanTile(tile)) {
+			m_items += removed;
+			++m_tiles;
+		}
+	}
+
+	++m_done;
+	return true;
+}
+
+void CleanJob::finish() {
+	std::clog << "> CLEAN: Removed " << m_items << " item" << (m_items != 1 ? "s" : "") << " from " << m_tiles << " tile" << (m_tiles != 1 ? "s" : "");
+	std::clog << " (" << m_list.size() << " were marked) in " << getDuration() / (1000.) << " seconds";
+	if (getTicks() > 1) {
+		std::clog << " over " << getTicks() << " cycles";
+	}
+
+	std::clog << "." << std::endl;
+}
+
+void RefreshJob::start() {
+	m_it = g_game.getRefreshTiles().begin();
+	m_total = g_game.getRefreshTiles().size();
+}
+
+bool RefreshJob::step() {
+	if (m_it == g_game.getRefreshTiles().end()) {
+		return false;
+	}
+
+	if (g_game.refreshTile(m_it->first, m_it->second)) {
+		++m_refreshed;
+	}
+
+	++m_it;
+
+	++m_done;
+	return true;
+}
+
+void RefreshJob::finish() {
+	std::clog << "> REFRESH: Refreshed " << m_refreshed << " of " << m_done << " tile" << (m_done != 1 ? "s" : "") << " in " << getDuration() / (1000.) << " seconds";
+	if (getTicks() > 1) {
+		std::clog << " over " << getTicks() << " cycles";
+	}
+
+	std::clog << "." << std::endl;
+}
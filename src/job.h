@@ -0,0 +1,158 @@
+/*
+* OpenTibia - an opensource roleplaying game.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __JOB__
+	#define __JOB__
+
+	#include "otsystem.h"
+
+	#include "game.h"
+	#define JOB_REPORT_INTERVAL 5000
+
+	// Maintenance work that is too big for a single dispatcher task. A job is
+	// split into small steps, Jobs runs as many of them as fit into the tick
+	// budget and yields back to the scheduler until the job is done.
+	class Job {
+		public:
+			Job(const std::string& name): m_name(name), m_done(0), m_total(0), m_ticks(0), m_start(0), m_lastReport(0) {}
+			virtual ~Job() {}
+
+			const std::string& getName() const {
+				return m_name;
+			}
+
+			uint32_t getDone() const {
+				return m_done;
+			}
+			uint32_t getTotal() const {
+				return m_total;
+			}
+
+			uint32_t getTicks() const {
+				return m_ticks;
+			}
+			int64_t getDuration() const {
+				return OTSYS_TIME() - m_start;
+			}
+
+			// collects the work, called on the game thread right before the first step
+			virtual void start() {}
+			// does one unit of work, returns false when there was nothing left to do
+			virtual bool step() = 0;
+			// called after the last step
+			virtual void finish() {}
+
+		protected:
+			std::string m_name;
+			uint32_t m_done, m_total, m_ticks;
+			int64_t m_start, m_lastReport;
+
+			friend class Jobs;
+	};
+
+	typedef std::list<Job*> JobList;
+	class Jobs {
+		public:
+			virtual ~Jobs() {}
+			static Jobs* getInstance() {
+				static Jobs instance;
+				return &instance;
+			}
+
+			// takes ownership, refuses the job while another one with the same name runs
+			bool add(Job* job);
+			// runs the whole job at once, for callers that need its result right away
+			void run(Job& job);
+
+			bool isRunning(const std::string& name) const;
+			const JobList& getJobs() const {
+				return m_jobs;
+			}
+
+		protected:
+			Jobs() {}
+			void tick(Job* job);
+
+			JobList m_jobs;
+	};
+
+	// statements of one player, house or the global storage, written in a single transaction
+	struct SaveBatch {
+		SaveBatch(): guid(0) {}
+
+		std::string name;
+		uint32_t guid;
+		DBStatementList statements;
+	};
+	typedef std::list<SaveBatch> SaveBatchList;
+
+	// The whole game state is serialized by start() within one tick, so players and houses
+	// are saved consistently, the steps only replay the recorded statements batch by batch.
+	class SaveJob : public Job {
+		public:
+			SaveJob(bool shallow): Job("save"), m_shallow(shallow) {}
+			virtual ~SaveJob() {}
+
+			virtual void start();
+			virtual bool step();
+			virtual void finish();
+
+			// a player saved directly (logout, death, scripts) is newer than the recorded
+			// statements, replaying them later would roll the player back
+			static void discardPlayer(uint32_t guid);
+
+		protected:
+			void addBatch(const std::string& name, uint32_t guid, DBStatementList& statements);
+
+			bool m_shallow;
+			SaveBatchList m_batches;
+			std::map<uint32_t, SaveBatchList::iterator> m_playerBatches;
+	};
+
+	class CleanJob : public Job {
+		public:
+			CleanJob(): Job("clean"), m_next(0), m_items(0), m_tiles(0) {}
+			virtual ~CleanJob() {}
+
+			virtual void start();
+			virtual bool step();
+			virtual void finish();
+
+			uint32_t getItems() const {
+				return m_items;
+			}
+
+		protected:
+			std::vector<Tile*> m_list;
+			size_t m_next;
+			uint32_t m_items, m_tiles;
+	};
+
+	class RefreshJob : public Job {
+		public:
+			RefreshJob(): Job("refresh"), m_refreshed(0) {}
+			virtual ~RefreshJob() {}
+
+			virtual void start();
+			virtual bool step();
+			virtual void finish();
+
+		protected:
+			RefreshTiles::const_iterator m_it;
+			uint32_t m_refreshed;
+	};
+#endif
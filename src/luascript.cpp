@@ -75,6 +75,7 @@ uint32_t ScriptEnviroment::m_lastConditionId = 0;
 ScriptEnviroment::ConditionMap ScriptEnviroment::m_tempConditionMap;
 
 ScriptEnviroment::ThingMap ScriptEnviroment::m_globalMap;
+bool ScriptEnviroment::m_uniqueDeferred = false;
 ScriptEnviroment::StorageMap ScriptEnviroment::m_storageMap;
 ScriptEnviroment::TempItemListMap ScriptEnviroment::m_tempItems;
 
@@ -199,6 +200,10 @@ void ScriptEnviroment::getInfo(int32_t& scriptId, std::string& desc, LuaInterfac
 }
 
 void ScriptEnviroment::addUniqueThing(Thing* thing) {
+	if (m_uniqueDeferred) {
+		return;
+	}
+
 	Item* item = thing->getItem();
 	if (!item || !item->getUniqueId()) {
 		return;
@@ -7778,8 +7783,11 @@ int32_t LuaInterface::luaAddEvent(lua_State* L) {
 		params.push_back(luaL_ref(L, LUA_REGISTRYINDEX));
 	}
 
+	SchedulerTask* task = createSchedulerTask(std::max((int64_t)SCHEDULER_MINTICKS, popNumber(L)), boost::bind(&LuaInterface::executeTimer, interface, ++interface->m_lastTimer));
+	task->setOrigin(interface->getName() + " addEvent from " + interface->getScript(env->getScriptId()));
+
 	LuaTimerEvent event;
-	event.eventId = Scheduler::getInstance().addEvent(createSchedulerTask(std::max((int64_t)SCHEDULER_MINTICKS, popNumber(L)), boost::bind(&LuaInterface::executeTimer, interface, ++interface->m_lastTimer)));
+	event.eventId = Scheduler::getInstance().addEvent(task);
 
 	event.parameters = params;
 	event.function = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -8704,7 +8712,7 @@ int32_t LuaInterface::luaDoSaveServer(lua_State* L) {
 		shallow = popNumber(L);
 	}
 
-	Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::saveGameState, &g_game, shallow)));
+	Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::proceduralSave, &g_game, shallow)));
 	lua_pushnil(L);
 	return 1;
 }
@@ -8902,6 +8910,8 @@ int32_t LuaInterface::luaGetItemAttribute(lua_State* L) {
 	boost::any value = item->getAttribute(key);
 	if (value.empty()) {
 		lua_pushnil(L);
+	} else if (key == "duration") {
+		lua_pushnumber(L, item->getDuration());
 	} else if (value.type() == typeid(std::string)) {
 		lua_pushstring(L, boost::any_cast<std::string>(value).c_str());
 	} else if (value.type() == typeid(int32_t)) {
@@ -8960,13 +8970,23 @@ int32_t LuaInterface::luaDoItemSetAttribute(lua_State* L) {
 			item->setUniqueId(tmp);
 		} else if (key == "aid") {
 			item->setActionId(boost::any_cast<int32_t>(value));
+		} else if (key == "duration") {
+			item->setDuration(boost::any_cast<int32_t>(value));
 		} else {
+			if (key == "decaying" && boost::any_cast<int32_t>(value) == DECAYING_FALSE) {
+				g_game.stopDecay(item);
+			}
+
 			item->setAttribute(key, boost::any_cast<int32_t>(value));
 		}
 	} else {
 		item->setAttribute(key, value);
 	}
 
+	if (House* house = Houses::getInstance()->getHouseByItem(item)) {
+		house->setDirty(true);
+	}
+
 	lua_pushboolean(L, true);
 	return 1;
 }
@@ -8988,11 +9008,19 @@ int32_t LuaInterface::luaDoItemEraseAttribute(lua_State* L) {
 		errorEx("Attempt to erase protected key \"uid\".");
 		ret = false;
 	} else if (key != "aid") {
+		if (key == "duration" || key == "decaying") {
+			g_game.stopDecay(item);
+		}
+
 		item->eraseAttribute(key);
 	} else {
 		item->resetActionId();
 	}
 
+	if (House* house = Houses::getInstance()->getHouseByItem(item)) {
+		house->setDirty(true);
+	}
+
 	lua_pushboolean(L, ret);
 	return 1;
 }
@@ -155,6 +155,10 @@
 
 			static void addUniqueThing(Thing* thing);
 			static void removeUniqueThing(Thing* thing);
+			// the map loader decodes items off the main thread and registers them afterwards
+			static void setUniqueThingsDeferred(bool deferred) {
+				m_uniqueDeferred = deferred;
+			}
 
 			static uint32_t getLastConditionId() {
 				return m_lastConditionId;
@@ -213,6 +217,7 @@
 			static TempItemListMap m_tempItems;
 			static StorageMap m_storageMap;
 			static ThingMap m_globalMap;
+			static bool m_uniqueDeferred;
 
 			static uint32_t m_lastAreaId;
 			static AreaMap m_areaMap;
@@ -39,6 +39,10 @@ extern Game g_game;
 Map::Map() {
 	mapWidth = 0;
 	mapHeight = 0;
+
+	leafIndexX = leafIndexY = leafIndexWidth = leafIndexHeight = 0;
+	leafMinX = leafMinY = 0xFFFF;
+	leafMaxX = leafMaxY = 0;
 }
 
 bool Map::loadMap(const std::string& identifier) {
@@ -49,6 +53,7 @@ bool Map::loadMap(const std::string& identifier) {
 		return false;
 	}
 
+	buildLeafIndex();
 	std::clog << "> Map loading time: " << (OTSYS_TIME() - start) / (1000.) << " seconds." << std::endl;
 	start = OTSYS_TIME();
 	if (!loader->loadSpawns(this)) {
@@ -75,49 +80,82 @@ bool Map::loadMap(const std::string& identifier) {
 	return true;
 }
 
-bool Map::saveMap() {
-	IOMapSerialize* IOLoader = IOMapSerialize::getInstance();
-	bool saved = false;
-	for (uint32_t tries = 0; tries < 3; ++tries) {
-		if (!IOLoader->saveHouses()) {
-			continue;
-		}
-
-		saved = true;
-		break;
-	}
-
-	if (!saved) {
-		return false;
+Tile* Map::getTile(int32_t x, int32_t y, int32_t z) {
+	Floor* floor = getFloor(x, y, z);
+	if (!floor) {
+		return NULL;
 	}
+	return floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+}
 
-	saved = false;
-	for (uint32_t tries = 0; tries < 3; ++tries) {
-		if (!IOLoader->saveMap(this)) {
-			continue;
-		}
-
-		saved = true;
-		break;
+uint32_t Map::getTileFlags(int32_t x, int32_t y, int32_t z) const {
+	Floor* floor = getFloor(x, y, z);
+	if (!floor) {
+		return 0;
 	}
-	return saved;
+	return floor->flags[x & FLOOR_MASK][y & FLOOR_MASK];
 }
 
-Tile* Map::getTile(int32_t x, int32_t y, int32_t z) {
+Floor* Map::getFloor(int32_t x, int32_t y, int32_t z) const {
 	if (x < 0 || x > 0xFFFF || y < 0 || y > 0xFFFF || z < 0 || z >= MAP_MAX_LAYERS) {
 		return NULL;
 	}
 
-	QTreeLeafNode* leaf = QTreeNode::getLeafStatic(&root, x, y);
+	QTreeLeafNode* leaf = findLeaf(x, y);
 	if (!leaf) {
 		return NULL;
 	}
+	return leaf->getFloor(z);
+}
 
-	Floor* floor = leaf->getFloor(z);
-	if (!floor) {
-		return NULL;
+QTreeLeafNode* Map::findLeaf(int32_t x, int32_t y) const {
+	// positions left or above the index wrap around and fail the bounds check
+	uint32_t indexX = (x >> FLOOR_BITS) - leafIndexX, indexY = (y >> FLOOR_BITS) - leafIndexY;
+	if (indexX < leafIndexWidth && indexY < leafIndexHeight) {
+		return leafIndex[indexY * leafIndexWidth + indexX];
 	}
-	return floor->tiles[x & FLOOR_MASK][y & FLOOR_MASK];
+	return QTreeNode::getLeafStatic(const_cast<QTreeNode*>(&root), x, y);
+}
+
+bool Map::hasPlayerInRange(const Position& centerPos, int32_t rangeX, int32_t rangeY) const {
+	int32_t x1 = std::max((int32_t)0, centerPos.x - rangeX), y1 = std::max((int32_t)0, centerPos.y - rangeY),
+		x2 = std::min((int32_t)0xFFFF, centerPos.x + rangeX), y2 = std::min((int32_t)0xFFFF, centerPos.y + rangeY);
+	for (int32_t ny = y1 - (y1 % FLOOR_SIZE); ny <= y2; ny += FLOOR_SIZE) {
+		for (int32_t nx = x1 - (x1 % FLOOR_SIZE); nx <= x2; nx += FLOOR_SIZE) {
+			QTreeLeafNode* leaf = findLeaf(nx, ny);
+			if (leaf && leaf->hasPlayers()) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void Map::buildLeafIndex() {
+	leafIndex.clear();
+	leafIndexWidth = leafIndexHeight = 0;
+	if (leafMinX > leafMaxX || leafMinY > leafMaxY) {
+		return;
+	}
+
+	uint32_t width = leafMaxX - leafMinX + 1, height = leafMaxY - leafMinY + 1;
+	if (width * height > MAP_LEAF_INDEX_MAX) {
+		std::clog << "[Warning - Map::buildLeafIndex] Map spans " << width * FLOOR_SIZE << "x" << height * FLOOR_SIZE
+			<< " tiles, too many for a flat index - using the quadtree only." << std::endl;
+		return;
+	}
+
+	leafIndex.resize(width * height, NULL);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			leafIndex[y * width + x] = root.getLeaf((leafMinX + x) << FLOOR_BITS, (leafMinY + y) << FLOOR_BITS);
+		}
+	}
+
+	leafIndexX = leafMinX;
+	leafIndexY = leafMinY;
+	leafIndexWidth = width;
+	leafIndexHeight = height;
 }
 
 void Map::setTile(uint16_t x, uint16_t y, uint16_t z, Tile* newTile) {
@@ -152,6 +190,17 @@ void Map::setTile(uint16_t x, uint16_t y, uint16_t z, Tile* newTile) {
 		if (eastLeaf) {
 			leaf->m_leafE = eastLeaf;
 		}
+
+		uint32_t leafX = x >> FLOOR_BITS, leafY = y >> FLOOR_BITS;
+		leafMinX = std::min(leafMinX, leafX);
+		leafMinY = std::min(leafMinY, leafY);
+		leafMaxX = std::max(leafMaxX, leafX);
+		leafMaxY = std::max(leafMaxY, leafY);
+
+		uint32_t indexX = leafX - leafIndexX, indexY = leafY - leafIndexY;
+		if (indexX < leafIndexWidth && indexY < leafIndexHeight) {
+			leafIndex[indexY * leafIndexWidth + indexX] = leaf;
+		}
 	}
 
 	uint32_t offsetX = x & FLOOR_MASK, offsetY = y & FLOOR_MASK;
@@ -159,18 +208,21 @@ void Map::setTile(uint16_t x, uint16_t y, uint16_t z, Tile* newTile) {
 	if (!floor->tiles[offsetX][offsetY]) {
 		floor->tiles[offsetX][offsetY] = newTile;
 		newTile->qt_node = leaf;
+		newTile->syncFlags();
 	} else {
 		std::clog << "[Error - Map::setTile] Tile already exists - pos " << offsetX << "/" << offsetY << "/" << z << std::endl;
 	}
 
 	if (newTile->hasFlag(TILESTATE_REFRESH)) {
-		RefreshBlock_t rb;
+		ItemVector* list = new ItemVector();
 		if (TileItemVector* tileItems = newTile->getItemList()) {
 			for (ItemVector::iterator it = tileItems->getBeginDownItem(); it != tileItems->getEndDownItem(); ++it) {
-				rb.list.push_back((*it)->clone());
+				list->push_back((*it)->clone());
 			}
 		}
 
+		RefreshBlock_t rb;
+		rb.list.reset(list);
 		rb.lastRefresh = OTSYS_TIME();
 		g_game.addRefreshTile(newTile, rb);
 	}
@@ -519,8 +571,7 @@ bool Map::checkSightLine(const Position& fromPos, const Position& toPos) const {
 			}
 
 			lastrx = rx; lastry = ry; lastrz = rz;
-			const Tile* tile = const_cast<Map*>(this)->getTile(rx, ry, rz);
-			if (tile && tile->hasProperty(BLOCKPROJECTILE)) {
+			if (getTileFlags(rx, ry, rz) & TILESTATE_BLOCKPROJECTILE) {
 				return false;
 			}
 		}
@@ -959,6 +1010,7 @@ Floor::Floor() {
 	for (int32_t i = 0; i < FLOOR_SIZE; ++i) {
 		for (int32_t j = 0; j < FLOOR_SIZE; ++j) {
 			tiles[i][j] = 0;
+			flags[i][j] = 0;
 		}
 	}
 }
@@ -1036,6 +1088,7 @@ QTreeLeafNode::QTreeLeafNode() {
 	m_isLeaf = true;
 	m_leafS = NULL;
 	m_leafE = NULL;
+	playerCount = 0;
 }
 
 QTreeLeafNode::~QTreeLeafNode() {
@@ -1044,6 +1097,22 @@ QTreeLeafNode::~QTreeLeafNode() {
 	}
 }
 
+void QTreeLeafNode::addCreature(Creature* c) {
+	creatureList.push_back(c);
+	if (c->getPlayer()) {
+		++playerCount;
+	}
+}
+
+void QTreeLeafNode::removeCreature(Creature* c) {
+	CreatureVector::iterator it = std::find(creatureList.begin(), creatureList.end(), c);
+	assert(it != creatureList.end());
+	creatureList.erase(it);
+	if (c->getPlayer()) {
+		--playerCount;
+	}
+}
+
 Floor* QTreeLeafNode::createFloor(uint16_t z) {
 	if (!m_array[z]) {
 		m_array[z] = new Floor();
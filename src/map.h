@@ -87,9 +87,15 @@
 	#define FLOOR_SIZE (1 << FLOOR_BITS)
 	#define FLOOR_MASK (FLOOR_SIZE - 1)
 
+	// largest flat leaf index built over the map, in leaves (8 bytes each)
+	#define MAP_LEAF_INDEX_MAX (1 << 21)
+
+	// the tile flags are mirrored next to the tile pointers, so scans over an
+	// area (sight lines) can test them without touching every Tile object
 	struct Floor {
 		Floor();
 		Tile* tiles[FLOOR_SIZE][FLOOR_SIZE];
+		uint32_t flags[FLOOR_SIZE][FLOOR_SIZE];
 	};
 
 	class FrozenPathingConditionCall;
@@ -137,8 +143,13 @@
 			void addCreature(Creature* c);
 			void removeCreature(Creature* c);
 
+			bool hasPlayers() const {
+				return playerCount != 0;
+			}
+
 		protected:
 			static bool newLeaf;
+			uint32_t playerCount;
 
 			QTreeLeafNode* m_leafS;
 			QTreeLeafNode* m_leafE;
@@ -171,13 +182,6 @@
 			*/
 			bool loadMap(const std::string& identifier);
 
-			/**
-			* Save a map.
-			* \param identifier file/database to save to
-			* \returns true if the map was saved successfully
-			*/
-			bool saveMap();
-
 			/**
 			* Get a single tile.
 			* \returns A pointer to that tile.
@@ -196,6 +200,12 @@
 				setTile(pos.x, pos.y, pos.z, newTile);
 			}
 
+			/**
+			* Get the flags of a single tile, without touching the tile itself.
+			* \returns The tileflags_t of that tile, 0 if there is no tile.
+			*/
+			uint32_t getTileFlags(int32_t x, int32_t y, int32_t z) const;
+
 			/**
 			* Place a creature on the map
 			* \param pos The position to place the creature
@@ -245,14 +255,27 @@
 			bool getPathMatching(const Creature* creature, std::list<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp);
 
 			QTreeLeafNode* getLeaf(uint16_t x, uint16_t y) {
-				return root.getLeaf(x, y);
+				return findLeaf(x, y);
 			}
+
+			// whether any player stands in the area, on any floor, counted per leaf
+			bool hasPlayerInRange(const Position& centerPos, int32_t rangeX, int32_t rangeY) const;
 			const Tile* canWalkTo(const Creature* creature, const Position& pos);
 			Waypoints waypoints;
 
 		protected:
 			QTreeNode root;
 
+			// flat array of the leaves covering the loaded map, so a lookup is
+			// a single index instead of walking all levels of the quadtree
+			std::vector<QTreeLeafNode*> leafIndex;
+			uint32_t leafIndexX, leafIndexY, leafIndexWidth, leafIndexHeight;
+			uint32_t leafMinX, leafMinY, leafMaxX, leafMaxY;
+
+			void buildLeafIndex();
+			QTreeLeafNode* findLeaf(int32_t x, int32_t y) const;
+			Floor* getFloor(int32_t x, int32_t y, int32_t z) const;
+
 			uint32_t mapWidth, mapHeight;
 			std::string spawnfile, housefile;
 			StringVec descriptions;
@@ -277,14 +300,4 @@
 			friend class Game;
 			friend class IOMap;
 	};
-
-	inline void QTreeLeafNode::addCreature(Creature* c) {
-		creatureList.push_back(c);
-	}
-
-	inline void QTreeLeafNode::removeCreature(Creature* c) {
-		CreatureVector::iterator it = std::find(creatureList.begin(), creatureList.end(), c);
-		assert(it != creatureList.end());
-		creatureList.erase(it);
-	}
 #endif
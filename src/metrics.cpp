@@ -0,0 +1,257 @@
+/*
+* OpenTibia - an opensource roleplaying game.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "otpch.h"
+#include <iomanip>
+#include <cmath>
+
+#include "metrics.h"
+
+#include "dispatcher.h"
+#include "scheduler.h"
+
+#ifdef __OTSERV_ALLOCATOR__
+	#include "allocator.h"
+#endif
+
+struct MetricInfo {
+	const char* name;
+	const char* help;
+	bool counter;
+};
+
+static const MetricInfo metricsInfo[METRIC_LAST] = {
+	{"otserv_players_online", "Players currently online.", false},
+	{"otserv_monsters_online", "Monsters currently spawned.", false},
+	{"otserv_npcs_online", "Npcs currently spawned.", false},
+	{"otserv_creature_ticks_total", "Creature check ticks run by the game.", true},
+	{"otserv_creatures_checked_total", "Creatures thought on during creature check ticks.", true},
+	{"otserv_connections", "Open network connections.", false},
+	{"otserv_output_messages", "OutputMessage objects owned by the pool.", false},
+	{"otserv_output_messages_used", "OutputMessage objects currently handed out by the pool.", false},
+	{"otserv_output_messages_autosend", "OutputMessage objects waiting for the next auto-send flush.", false},
+	{"otserv_moveevent_lookups_total", "Move event lookups by position, item, action or unique id.", true},
+	{"otserv_moveevent_lookups_skipped_total", "Move event lookups answered by the filters without searching a map.", true},
+	{"otserv_creatures_active", "Creatures scheduled for creature checks.", false},
+	{"otserv_spawns_hibernating", "Spawns hibernating with no player nearby.", false},
+	{"otserv_monsters_hibernating", "Spawned monsters held by hibernating spawns.", false}
+};
+
+static const MetricInfo histogramsInfo[METRIC_HISTOGRAM_LAST] = {
+	{"otserv_database_query_duration_seconds", "Execution time of database queries.", false}
+};
+
+Histogram::Histogram() {
+	for (uint32_t i = 0; i < METRICS_HISTOGRAM_BUCKETS; ++i) {
+		m_buckets[i] = m_window[0][i] = m_window[1][i] = 0;
+	}
+
+	m_count = m_sum = 0;
+	m_windowStart = OTSYS_TIME();
+	m_windowIndex = 0;
+}
+
+uint32_t Histogram::getBucket(uint64_t value) {
+	uint32_t bucket = 0;
+	while (bucket < METRICS_HISTOGRAM_BUCKETS - 1 && value >= getBucketBound(bucket)) {
+		++bucket;
+	}
+	return bucket;
+}
+
+void Histogram::add(uint64_t value) {
+	int64_t now = OTSYS_TIME(), start = m_windowStart.load(boost::memory_order_relaxed);
+	// several threads may write, only the one that moves the window start rotates
+	if (now - start >= METRICS_WINDOW_INTERVAL && m_windowStart.compare_exchange_strong(start, now, boost::memory_order_relaxed)) {
+		// the oldest window becomes the current one
+		uint32_t next = m_windowIndex.load(boost::memory_order_relaxed) ^ 1;
+		for (uint32_t i = 0; i < METRICS_HISTOGRAM_BUCKETS; ++i) {
+			m_window[next][i].store(0, boost::memory_order_relaxed);
+		}
+
+		m_windowIndex.store(next, boost::memory_order_release);
+	}
+
+	uint32_t index = m_windowIndex.load(boost::memory_order_acquire), bucket = getBucket(value);
+	m_buckets[bucket].fetch_add(1, boost::memory_order_relaxed);
+	m_window[index][bucket].fetch_add(1, boost::memory_order_relaxed);
+
+	m_count.fetch_add(1, boost::memory_order_relaxed);
+	m_sum.fetch_add(value, boost::memory_order_relaxed);
+}
+
+uint64_t Histogram::getPercentile(double percentile) const {
+	uint64_t counts[METRICS_HISTOGRAM_BUCKETS], total = 0;
+	for (uint32_t i = 0; i < METRICS_HISTOGRAM_BUCKETS; ++i) {
+		counts[i] = m_window[0][i].load(boost::memory_order_relaxed) + m_window[1][i].load(boost::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	if (!total) {
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t)std::ceil(total * percentile), seen = 0;
+	for (uint32_t i = 0; i < METRICS_HISTOGRAM_BUCKETS; ++i) {
+		seen += counts[i];
+		if (seen >= rank) {
+			return getBucketBound(i);
+		}
+	}
+	return getBucketBound(METRICS_HISTOGRAM_BUCKETS - 1);
+}
+
+void Histogram::serialize(std::ostream& os, const std::string& name, const std::string& help, double scale) const {
+	Metrics::writeHeader(os, name, help, "histogram");
+
+	uint64_t cumulative = 0;
+	for (uint32_t i = 0; i < METRICS_HISTOGRAM_BUCKETS - 1; ++i) {
+		cumulative += m_buckets[i].load(boost::memory_order_relaxed);
+		os << name << "_bucket{le=\"" << getBucketBound(i) * scale << "\"} " << cumulative << "\n";
+	}
+
+	cumulative += m_buckets[METRICS_HISTOGRAM_BUCKETS - 1].load(boost::memory_order_relaxed);
+	os << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+	os << name << "_sum " << getSum() * scale << "\n";
+	os << name << "_count " << getCount() << "\n";
+
+	Metrics::writeHeader(os, name + "_window", help + " Live quantiles over the last one to two minutes.", "gauge");
+	os << name << "_window{quantile=\"0.5\"} " << getPercentile(0.5) * scale << "\n";
+	os << name << "_window{quantile=\"0.99\"} " << getPercentile(0.99) * scale << "\n";
+}
+
+void Metrics::writeHeader(std::ostream& os, const std::string& name, const std::string& help, const std::string& type) {
+	os << "# HELP " << name << " " << help << "\n";
+	os << "# TYPE " << name << " " << type << "\n";
+}
+
+void Metrics::writeGauge(std::ostream& os, const std::string& name, const std::string& help, double value) {
+	writeHeader(os, name, help, "gauge");
+	os << name << " " << value << "\n";
+}
+
+void Metrics::writeCounter(std::ostream& os, const std::string& name, const std::string& help, double value) {
+	writeHeader(os, name, help, "counter");
+	os << name << " " << value << "\n";
+}
+
+Metrics::Metrics() {
+	for (uint32_t i = 0; i < METRIC_LAST; ++i) {
+		m_values[i] = 0;
+	}
+
+	for (uint32_t i = 0; i < METRICS_MAX_PROTOCOLS; ++i) {
+		m_protocolNames[i] = NULL;
+		m_bytesIn[i] = m_bytesOut[i] = 0;
+	}
+
+	// traffic that arrives before the protocol is known
+	m_protocolNames[0] = "unknown";
+	m_protocolCount = 1;
+}
+
+uint8_t Metrics::registerProtocol(const char* name) {
+	uint32_t count = m_protocolCount.load(boost::memory_order_acquire);
+	for (uint32_t i = 0; i < count; ++i) {
+		if (!strcmp(m_protocolNames[i], name)) {
+			return i;
+		}
+	}
+
+	if (count >= METRICS_MAX_PROTOCOLS) {
+		return 0;
+	}
+
+	m_protocolNames[count] = name;
+	m_protocolCount.store(count + 1, boost::memory_order_release);
+	return count;
+}
+
+std::string Metrics::getPrometheusText() const {
+	std::stringstream s;
+	s << std::setprecision(12);
+	for (uint32_t i = 0; i < METRIC_LAST; ++i) {
+		if (metricsInfo[i].counter) {
+			writeCounter(s, metricsInfo[i].name, metricsInfo[i].help, get((MetricValue_t)i));
+		} else {
+			writeGauge(s, metricsInfo[i].name, metricsInfo[i].help, get((MetricValue_t)i));
+		}
+	}
+
+	for (uint32_t i = 0; i < METRIC_HISTOGRAM_LAST; ++i) {
+		m_histograms[i].serialize(s, histogramsInfo[i].name, histogramsInfo[i].help, 0.000001);
+	}
+
+	uint32_t protocols = m_protocolCount.load(boost::memory_order_acquire);
+	writeHeader(s, "otserv_network_received_bytes_total", "Bytes received per protocol.", "counter");
+	for (uint32_t i = 0; i < protocols; ++i) {
+		s << "otserv_network_received_bytes_total{protocol=\"" << m_protocolNames[i] << "\"} " << m_bytesIn[i].load(boost::memory_order_relaxed) << "\n";
+	}
+
+	writeHeader(s, "otserv_network_sent_bytes_total", "Bytes sent per protocol.", "counter");
+	for (uint32_t i = 0; i < protocols; ++i) {
+		s << "otserv_network_sent_bytes_total{protocol=\"" << m_protocolNames[i] << "\"} " << m_bytesOut[i].load(boost::memory_order_relaxed) << "\n";
+	}
+
+	#ifdef __OTSERV_ALLOCATOR__
+		const PoolManager* poolManager = PoolManager::getInstance();
+		writeCounter(s, "otserv_allocator_allocations_total", "Allocations served by the pool allocator.", poolManager->getAllocations());
+		writeCounter(s, "otserv_allocator_deallocations_total", "Deallocations returned to the pool allocator.", poolManager->getDeallocations());
+		writeCounter(s, "otserv_allocator_large_allocations_total", "Allocations too big for any pool, served by malloc.", poolManager->getLargeAllocations());
+		writeGauge(s, "otserv_allocator_pooled_bytes", "Bytes currently handed out from the pools.", poolManager->getPooledBytes());
+
+		SlabAllocators allocators;
+		SlabAllocator::getAllocators(allocators);
+
+		writeHeader(s, "otserv_slab_live_objects", "Objects currently allocated per class.", "gauge");
+		for (SlabAllocators::iterator it = allocators.begin(); it != allocators.end(); ++it) {
+			s << "otserv_slab_live_objects{class=\"" << (*it)->getName() << "\"} " << (*it)->getLive() << "\n";
+		}
+
+		writeHeader(s, "otserv_slab_allocations_total", "Allocations served from the per-class slabs.", "counter");
+		for (SlabAllocators::iterator it = allocators.begin(); it != allocators.end(); ++it) {
+			s << "otserv_slab_allocations_total{class=\"" << (*it)->getName() << "\"} " << (*it)->getAllocations() << "\n";
+		}
+
+		writeHeader(s, "otserv_slab_fallback_allocations_total", "Allocations of derived classes too big for the slab slot.", "counter");
+		for (SlabAllocators::iterator it = allocators.begin(); it != allocators.end(); ++it) {
+			s << "otserv_slab_fallback_allocations_total{class=\"" << (*it)->getName() << "\"} " << (*it)->getFallbacks() << "\n";
+		}
+
+		writeHeader(s, "otserv_slab_reserved_bytes", "Bytes reserved in slabs per class.", "gauge");
+		for (SlabAllocators::iterator it = allocators.begin(); it != allocators.end(); ++it) {
+			s << "otserv_slab_reserved_bytes{class=\"" << (*it)->getName() << "\"} " << (*it)->getReservedBytes() << "\n";
+		}
+
+		writeHeader(s, "otserv_slab_fragmentation_ratio", "Share of the reserved slab bytes not used by live objects.", "gauge");
+		for (SlabAllocators::iterator it = allocators.begin(); it != allocators.end(); ++it) {
+			s << "otserv_slab_fragmentation_ratio{class=\"" << (*it)->getName() << "\"} " << (*it)->getFragmentation() << "\n";
+		}
+	#endif
+
+	const Dispatcher& dispatcher = Dispatcher::getInstance();
+	writeGauge(s, "otserv_dispatcher_queue_depth", "Tasks waiting in the dispatcher queue.", dispatcher.getTaskCount());
+	dispatcher.getQueueDepth().serialize(s, "otserv_dispatcher_queue_depth_sampled", "Dispatcher queue depth sampled whenever a task starts.");
+	dispatcher.getQueueLatency().serialize(s, "otserv_dispatcher_queue_latency_seconds", "Time between queueing a task and starting it.", 0.000001);
+	dispatcher.getTaskDuration().serialize(s, "otserv_dispatcher_task_duration_seconds", "Execution time of dispatcher tasks.", 0.000001);
+	writeCounter(s, "otserv_dispatcher_slow_tasks_total", "Tasks that exceeded dispatcherTaskBudget.", dispatcher.getSlowTaskCount());
+
+	const Scheduler& scheduler = Scheduler::getInstance();
+	writeGauge(s, "otserv_scheduler_queue_depth", "Events waiting in the scheduler queue.", scheduler.getEventCount());
+	scheduler.getLateness().serialize(s, "otserv_scheduler_lateness_seconds", "Delay between an event's due time and its hand-off to the dispatcher.", 0.000001);
+	return s.str();
+}
@@ -0,0 +1,152 @@
+/*
+* OpenTibia - an opensource roleplaying game.
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __METRICS__
+	#define __METRICS__
+
+	#include "otsystem.h"
+	#include <boost/atomic.hpp>
+
+	#define METRICS_HISTOGRAM_BUCKETS 24
+	#define METRICS_WINDOW_INTERVAL 60000
+	#define METRICS_MAX_PROTOCOLS 16
+
+	typedef boost::atomic<uint64_t> MetricCounter;
+
+	enum MetricValue_t {
+		METRIC_PLAYERS_ONLINE = 0,
+		METRIC_MONSTERS_ONLINE,
+		METRIC_NPCS_ONLINE,
+		METRIC_CREATURE_TICKS,
+		METRIC_CREATURES_CHECKED,
+		METRIC_CONNECTIONS,
+		METRIC_OUTPUT_MESSAGES,
+		METRIC_OUTPUT_MESSAGES_USED,
+		METRIC_OUTPUT_MESSAGES_AUTOSEND,
+		METRIC_MOVEEVENT_LOOKUPS,
+		METRIC_MOVEEVENT_LOOKUPS_SKIPPED,
+		METRIC_CREATURES_ACTIVE,
+		METRIC_SPAWNS_HIBERNATING,
+		METRIC_MONSTERS_HIBERNATING,
+		METRIC_LAST /* this must be the last one */
+	};
+
+	enum MetricHistogram_t {
+		METRIC_HISTOGRAM_DATABASE_QUERY = 0,
+		METRIC_HISTOGRAM_LAST /* this must be the last one */
+	};
+
+	// power-of-two bucketed histogram, may be fed and read by any thread (the database one
+	// is written by both the dispatcher and the house writer); besides the lifetime totals it
+	// keeps two rotating windows used for the live percentiles, a sample racing a rotation may
+	// be dropped from the windows but never from the totals
+	class Histogram : boost::noncopyable {
+		public:
+			Histogram();
+			virtual ~Histogram() {}
+
+			void add(uint64_t value);
+
+			uint64_t getCount() const {
+				return m_count.load(boost::memory_order_relaxed);
+			}
+			uint64_t getSum() const {
+				return m_sum.load(boost::memory_order_relaxed);
+			}
+
+			uint64_t getPercentile(double percentile) const;
+			void serialize(std::ostream& os, const std::string& name, const std::string& help, double scale = 1.0) const;
+
+			static uint64_t getBucketBound(uint32_t bucket) {
+				return (uint64_t)1 << bucket;
+			}
+
+		protected:
+			static uint32_t getBucket(uint64_t value);
+
+			MetricCounter m_buckets[METRICS_HISTOGRAM_BUCKETS], m_window[2][METRICS_HISTOGRAM_BUCKETS];
+			MetricCounter m_count, m_sum;
+
+			boost::atomic<int64_t> m_windowStart;
+			boost::atomic<uint32_t> m_windowIndex;
+	};
+
+	class HistogramTimer : boost::noncopyable {
+		public:
+			HistogramTimer(Histogram& histogram): m_histogram(histogram), m_start(OTSYS_TIME_MICRO()) {}
+			virtual ~HistogramTimer() {
+				m_histogram.add(std::max((int64_t)0, OTSYS_TIME_MICRO() - m_start));
+			}
+
+		protected:
+			Histogram& m_histogram;
+			int64_t m_start;
+	};
+
+	// everything in here is written by the game and network threads and read by the scraper
+	// without taking any lock, so the values only have to be consistent one by one
+	class Metrics {
+		public:
+			virtual ~Metrics() {}
+			static Metrics* getInstance() {
+				static Metrics instance;
+				return &instance;
+			}
+
+			void set(MetricValue_t metric, uint64_t value) {
+				m_values[metric].store(value, boost::memory_order_relaxed);
+			}
+			void add(MetricValue_t metric, int64_t value = 1) {
+				m_values[metric].fetch_add(value, boost::memory_order_relaxed);
+			}
+			uint64_t get(MetricValue_t metric) const {
+				return m_values[metric].load(boost::memory_order_relaxed);
+			}
+
+			Histogram& getHistogram(MetricHistogram_t histogram) {
+				return m_histograms[histogram];
+			}
+
+			// protocols are registered on startup, before any connection is accepted
+			uint8_t registerProtocol(const char* name);
+			void addTraffic(uint8_t protocol, uint64_t bytesIn, uint64_t bytesOut) {
+				if (bytesIn) {
+					m_bytesIn[protocol].fetch_add(bytesIn, boost::memory_order_relaxed);
+				}
+
+				if (bytesOut) {
+					m_bytesOut[protocol].fetch_add(bytesOut, boost::memory_order_relaxed);
+				}
+			}
+
+			std::string getPrometheusText() const;
+
+			static void writeHeader(std::ostream& os, const std::string& name, const std::string& help, const std::string& type);
+			static void writeGauge(std::ostream& os, const std::string& name, const std::string& help, double value);
+			static void writeCounter(std::ostream& os, const std::string& name, const std::string& help, double value);
+
+		protected:
+			Metrics();
+
+			MetricCounter m_values[METRIC_LAST];
+			Histogram m_histograms[METRIC_HISTOGRAM_LAST];
+
+			const char* m_protocolNames[METRICS_MAX_PROTOCOLS];
+			MetricCounter m_bytesIn[METRICS_MAX_PROTOCOLS], m_bytesOut[METRICS_MAX_PROTOCOLS];
+			boost::atomic<uint32_t> m_protocolCount;
+	};
+#endif
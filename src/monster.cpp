@@ -52,6 +52,7 @@ Monster* Monster::createMonster(const std::string& name) {
 Monster::Monster(MonsterType* _mType):
 	Creature() {
 		isIdle = true;
+		targetListStale = true;
 		isMasterInRange = false;
 		teleportToMaster = false;
 		mType = _mType;
@@ -167,7 +168,7 @@ void Monster::onCreatureMove(const Creature* creature, const Tile* newTile, cons
 			isMasterInRange = canSee(master->getPosition());
 		}
 
-		updateTargetList();
+		updateTargetList(oldPos, newPos, teleport);
 		updateIdleStatus();
 	} else {
 		bool canSeeNewPos = canSee(newPos), canSeeOldPos = canSee(oldPos);
@@ -189,9 +190,52 @@ void Monster::onCreatureMove(const Creature* creature, const Tile* newTile, cons
 }
 
 void Monster::updateTargetList() {
+	pruneTargetList();
+	// going idle while scanning clears the lists again and marks them stale
+	targetListStale = false;
+
+	const SpectatorVec& list = g_game.getSpectators(getPosition());
+	for (SpectatorVec::const_iterator it = list.begin(); it != list.end(); ++it) {
+		if ((*it) != this && canSee((*it)->getPosition())) {
+			onCreatureFound(*it);
+		}
+	}
+}
+
+void Monster::updateTargetList(const Position& oldPos, const Position& newPos, bool teleport) {
+	int32_t dx = newPos.x - oldPos.x, dy = newPos.y - oldPos.y;
+	if (targetListStale || teleport || oldPos.z != newPos.z || std::abs(dx) > 1 || std::abs(dy) > 1) {
+		updateTargetList();
+		return;
+	}
+
+	// a single step only uncovers the leading row and column of the view, anyone
+	// else in sight has already been reported through enter and leave events
+	pruneTargetList();
+
+	SpectatorVec list;
+	if (dx) {
+		int32_t edge = dx * Map::maxViewportX;
+		g_game.getSpectators(list, newPos, false, true, -edge, edge, Map::maxViewportY, Map::maxViewportY);
+	}
+
+	if (dy) {
+		int32_t edge = dy * Map::maxViewportY;
+		g_game.getSpectators(list, newPos, false, true, Map::maxViewportX, Map::maxViewportX, -edge, edge);
+	}
+
+	for (SpectatorVec::const_iterator it = list.begin(); it != list.end(); ++it) {
+		if ((*it) != this && canSee((*it)->getPosition())) {
+			onCreatureFound(*it);
+		}
+	}
+}
+
+void Monster::pruneTargetList() {
 	CreatureList::iterator it;
 	for (it = friendList.begin(); it != friendList.end();) {
 		if ((*it)->getHealth() <= 0 || !canSee((*it)->getPosition())) {
+			friendIndex.erase(*it);
 			(*it)->unRef();
 			it = friendList.erase(it);
 		} else {
@@ -201,53 +245,49 @@ void Monster::updateTargetList() {
 
 	for (it = targetList.begin(); it != targetList.end();) {
 		if ((*it)->getHealth() <= 0 || !canSee((*it)->getPosition())) {
+			targetIndex.erase(*it);
 			(*it)->unRef();
 			it = targetList.erase(it);
 		} else {
 			++it;
 		}
 	}
-
-	const SpectatorVec& list = g_game.getSpectators(getPosition());
-	for (SpectatorVec::const_iterator it = list.begin(); it != list.end(); ++it) {
-		if ((*it) != this && canSee((*it)->getPosition())) {
-			onCreatureFound(*it);
-		}
-	}
 }
 
 void Monster::clearTargetList() {
 	for (CreatureList::iterator it = targetList.begin(); it != targetList.end(); ++it) {
 		(*it)->unRef();
 	}
+
 	targetList.clear();
+	targetIndex.clear();
+	targetListStale = true;
 }
 
 void Monster::clearFriendList() {
 	for (CreatureList::iterator it = friendList.begin(); it != friendList.end(); ++it) {
 		(*it)->unRef();
 	}
+
 	friendList.clear();
+	friendIndex.clear();
+	targetListStale = true;
 }
 
 void Monster::onCreatureFound(Creature* creature, bool pushFront) {
 	if (isFriend(creature)) {
 		assert(creature != this);
-		if (std::find(friendList.begin(), friendList.end(), creature) == friendList.end()) {
+		if (friendIndex.find(creature) == friendIndex.end()) {
 			creature->addRef();
-			friendList.push_back(creature);
+			friendIndex[creature] = friendList.insert(friendList.end(), creature);
 		}
 	}
 
 	if (isOpponent(creature)) {
 		assert(creature != this);
-		if (std::find(targetList.begin(), targetList.end(), creature) == targetList.end()) {
+		if (targetIndex.find(creature) == targetIndex.end()) {
 			creature->addRef();
-			if (pushFront) {
-				targetList.push_front(creature);
-			} else {
-				targetList.push_back(creature);
-			}
+			targetIndex[creature] = targetList.insert(pushFront ? targetList.begin() : targetList.end(), creature);
 		}
 	}
 	updateIdleStatus();
@@ -313,10 +353,11 @@ void Monster::onCreatureLeave(Creature* creature) {
 
 	// update friendList
 	if (isFriend(creature)) {
-		CreatureList::iterator it = std::find(friendList.begin(), friendList.end(), creature);
-		if (it != friendList.end()) {
-			(*it)->unRef();
-			friendList.erase(it);
+		CreatureIndex::iterator it = friendIndex.find(creature);
+		if (it != friendIndex.end()) {
+			friendList.erase(it->second);
+			friendIndex.erase(it);
+			creature->unRef();
 		}
 
 		#ifdef __DEBUG__
@@ -328,10 +369,11 @@ void Monster::onCreatureLeave(Creature* creature) {
 
 	// update targetList
 	if (isOpponent(creature)) {
-		CreatureList::iterator it = std::find(targetList.begin(), targetList.end(), creature);
-		if (it != targetList.end()) {
-			(*it)->unRef();
-			targetList.erase(it);
+		CreatureIndex::iterator it = targetIndex.find(creature);
+		if (it != targetIndex.end()) {
+			targetList.erase(it->second);
+			targetIndex.erase(it);
+			creature->unRef();
 			if (targetList.empty()) {
 				updateIdleStatus();
 			}
@@ -413,16 +455,17 @@ void Monster::onFollowCreatureComplete(const Creature* creature) {
 		return;
 	}
 
-	CreatureList::iterator it = std::find(targetList.begin(), targetList.end(), creature);
-	if (it != targetList.end()) {
-		Creature* target = (*it);
-		targetList.erase(it);
-
+	CreatureIndex::iterator it = targetIndex.find(const_cast<Creature*>(creature));
+	if (it != targetIndex.end()) {
 		if (hasFollowPath) { // push target we have found a path to the front
-			targetList.push_front(target);
+			targetList.splice(targetList.begin(), targetList, it->second);
 		} else if (!isSummon()) { // push target we have not found a path to the back
-			targetList.push_back(target);
+			targetList.splice(targetList.end(), targetList, it->second);
 		} else { // Since we removed the creature from the targetList (and not put it back) we have to release it too
+			Creature* target = it->first;
+			targetList.erase(it->second);
+			targetIndex.erase(it);
+			targetListStale = true;
 			target->unRef();
 		}
 	}
@@ -467,8 +510,7 @@ bool Monster::selectTarget(Creature* creature) {
 		return false;
 	}
 
-	CreatureList::iterator it = std::find(targetList.begin(), targetList.end(), creature);
-	if (it == targetList.end()) { // Target not found in our target list.
+	if (targetIndex.find(creature) == targetIndex.end()) { // Target not found in our target list.
 		#ifdef __DEBUG__
 			std::clog << "Target not found in targetList." << std::endl;
 		#endif
@@ -18,6 +18,8 @@
 #ifndef __MONSTER__
 	#define __MONSTER__
 
+	#include <boost/tr1/unordered_map.hpp>
+
 	#include "monsters.h"
 	#include "raids.h"
 	#include "tile.h"
@@ -34,6 +36,7 @@
 	};
 
 	typedef std::list<Creature*> CreatureList;
+	typedef std::tr1::unordered_map<Creature*, CreatureList::iterator> CreatureIndex;
 	class Monster : public Creature {
 		private:
 			Monster(MonsterType* _mType);
@@ -172,6 +175,10 @@
 		private:
 			CreatureList targetList;
 			CreatureList friendList;
+			CreatureIndex targetIndex;
+			CreatureIndex friendIndex;
+			// set when the lists no longer mirror the view, e.g. after going idle
+			bool targetListStale;
 
 			MonsterType* mType;
 
@@ -201,6 +208,8 @@
 			void updateLookDirection();
 
 			void updateTargetList();
+			void updateTargetList(const Position& oldPos, const Position& newPos, bool teleport);
+			void pruneTargetList();
 			void clearTargetList();
 			void clearFriendList();
 
@@ -30,6 +30,7 @@
 
 #include "combat.h"
 #include "game.h"
+#include "metrics.h"
 
 extern Game g_game;
 extern MoveEvents* g_moveEvents;
@@ -112,12 +113,13 @@ int32_t MoveEventScript::luaCallFunction(lua_State* L) {
 }
 
 MoveEvents::MoveEvents():
-	m_lastCacheTile(NULL) {
+	m_lookups(0), m_lookupsSkipped(0), m_lastCacheTile(NULL) {
 		m_interface.initState();
 	}
 
-inline void MoveEvents::clearMap(MoveListMap& map) {
-	for (MoveListMap::iterator it = map.begin(); it != map.end(); ++it) {
+template<class Index>
+inline void MoveEvents::clearMap(Index& map) {
+	for (typename Index::iterator it = map.events.begin(); it != map.events.end(); ++it) {
 		for (int32_t i = MOVE_EVENT_FIRST; i <= MOVE_EVENT_LAST; ++i) {
 			EventList& moveEventList = it->second.moveEvent[i];
 			for (EventList::iterator it = moveEventList.begin(); it != moveEventList.end(); ++it) {
@@ -129,22 +131,31 @@ inline void MoveEvents::clearMap(MoveListMap& map) {
 	map.clear();
 }
 
+template<class Index>
+inline MoveEvents::MoveEventList* MoveEvents::findEvents(Index& map, const typename Index::Key& key) {
+	if (++m_lookups >= MOVE_STATS_FLUSH) {
+		Metrics::getInstance()->add(METRIC_MOVEEVENT_LOOKUPS, m_lookups);
+		Metrics::getInstance()->add(METRIC_MOVEEVENT_LOOKUPS_SKIPPED, m_lookupsSkipped);
+		m_lookups = m_lookupsSkipped = 0;
+	}
+
+	if (!map.mayContain(key)) {
+		++m_lookupsSkipped;
+		return NULL;
+	}
+
+	typename Index::iterator it = map.events.find(key);
+	if (it == map.events.end()) {
+		return NULL;
+	}
+	return &it->second;
+}
+
 void MoveEvents::clear() {
 	clearMap(m_itemIdMap);
 	clearMap(m_actionIdMap);
 	clearMap(m_uniqueIdMap);
-
-	for (MovePosListMap::iterator it = m_positionMap.begin(); it != m_positionMap.end(); ++it) {
-		for (int32_t i = MOVE_EVENT_FIRST; i <= MOVE_EVENT_LAST; ++i) {
-			EventList& moveEventList = it->second.moveEvent[i];
-			for (EventList::iterator it = moveEventList.begin(); it != moveEventList.end(); ++it) {
-				delete (*it);
-			}
-			moveEventList.clear();
-		}
-	}
-
-	m_positionMap.clear();
+	clearMap(m_positionMap);
 	m_interface.reInitState();
 
 	m_lastCacheTile = NULL;
@@ -332,8 +343,8 @@ bool MoveEvents::registerEvent(Event* event, xmlNodePtr p, bool override) {
 }
 
 void MoveEvents::addEvent(MoveEvent* moveEvent, int32_t id, MoveListMap& map, bool override) {
-	MoveListMap::iterator it = map.find(id);
-	if (it != map.end()) {
+	MoveListMap::iterator it = map.events.find(id);
+	if (it != map.events.end()) {
 		EventList& moveEventList = it->second.moveEvent[moveEvent->getEventType()];
 		for (EventList::iterator it = moveEventList.begin(); it != moveEventList.end(); ++it) {
 			if ((*it)->getSlot() != moveEvent->getSlot()) {
@@ -352,16 +363,16 @@ void MoveEvents::addEvent(MoveEvent* moveEvent, int32_t id, MoveListMap& map, bo
 	} else {
 		MoveEventList moveEventList;
 		moveEventList.moveEvent[moveEvent->getEventType()].push_back(moveEvent);
-		map[id] = moveEventList;
+		map.events[id] = moveEventList;
+		map.add(id);
 	}
 }
 
 MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType) {
-	MoveListMap::iterator it;
+	MoveEventList* moveEvents = NULL;
 	if (item->getUniqueId()) {
-		it = m_uniqueIdMap.find(item->getUniqueId());
-		if (it != m_uniqueIdMap.end()) {
-			EventList& moveEventList = it->second.moveEvent[eventType];
+		if ((moveEvents = findEvents(m_uniqueIdMap, item->getUniqueId()))) {
+			EventList& moveEventList = moveEvents->moveEvent[eventType];
 			if (!moveEventList.empty()) {
 				return *moveEventList.begin();
 			}
@@ -369,18 +380,16 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType) {
 	}
 
 	if (item->getActionId()) {
-		it = m_actionIdMap.find(item->getActionId());
-		if (it != m_actionIdMap.end()) {
-			EventList& moveEventList = it->second.moveEvent[eventType];
+		if ((moveEvents = findEvents(m_actionIdMap, item->getActionId()))) {
+			EventList& moveEventList = moveEvents->moveEvent[eventType];
 			if (!moveEventList.empty()) {
 				return *moveEventList.begin();
 			}
 		}
 	}
 
-	it = m_itemIdMap.find(item->getID());
-	if (it != m_itemIdMap.end()) {
-		EventList& moveEventList = it->second.moveEvent[eventType];
+	if ((moveEvents = findEvents(m_itemIdMap, item->getID()))) {
+		EventList& moveEventList = moveEvents->moveEvent[eventType];
 		if (!moveEventList.empty()) {
 			return *moveEventList.begin();
 		}
@@ -446,12 +455,12 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType, slots_t slot)
 		}
 	}
 
-	MoveListMap::iterator it = m_itemIdMap.find(item->getID());
-	if (it == m_itemIdMap.end()) {
+	MoveEventList* moveEvents = findEvents(m_itemIdMap, item->getID());
+	if (!moveEvents) {
 		return NULL;
 	}
 
-	EventList& moveEventList = it->second.moveEvent[eventType];
+	EventList& moveEventList = moveEvents->moveEvent[eventType];
 	for (EventList::iterator it = moveEventList.begin(); it != moveEventList.end(); ++it) {
 		if (((*it)->getSlot() & slotp)) {
 			return *it;
@@ -461,8 +470,8 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType, slots_t slot)
 }
 
 void MoveEvents::addEvent(MoveEvent* moveEvent, Position pos, MovePosListMap& map, bool override) {
-	MovePosListMap::iterator it = map.find(pos);
-	if (it != map.end()) {
+	MovePosListMap::iterator it = map.events.find(pos);
+	if (it != map.events.end()) {
 		bool add = true;
 		if (!it->second.moveEvent[moveEvent->getEventType()].empty()) {
 			if (!override) {
@@ -479,17 +488,18 @@ void MoveEvents::addEvent(MoveEvent* moveEvent, Position pos, MovePosListMap& ma
 	} else {
 		MoveEventList moveEventList;
 		moveEventList.moveEvent[moveEvent->getEventType()].push_back(moveEvent);
-		map[pos] = moveEventList;
+		map.events[pos] = moveEventList;
+		map.add(pos);
 	}
 }
 
 MoveEvent* MoveEvents::getEvent(const Tile* tile, MoveEvent_t eventType) {
-	MovePosListMap::iterator it = m_positionMap.find(tile->getPosition());
-	if (it == m_positionMap.end()) {
+	MoveEventList* moveEvents = findEvents(m_positionMap, tile->getPosition());
+	if (!moveEvents) {
 		return NULL;
 	}
 
-	EventList& moveEventList = it->second.moveEvent[eventType];
+	EventList& moveEventList = moveEvents->moveEvent[eventType];
 	if (!moveEventList.empty()) {
 		return *moveEventList.begin();
 	}
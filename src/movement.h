@@ -18,9 +18,16 @@
 #ifndef __MOVEMENT__
 	#define __MOVEMENT__
 
+	#include <bitset>
+	#include <boost/tr1/unordered_map.hpp>
+
 	#include "baseevents.h"
 	#include "creature.h"
 
+	#define MOVE_FILTER_SIZE (1 << 16)
+	#define MOVE_FILTER_MASK (MOVE_FILTER_SIZE - 1)
+	#define MOVE_STATS_FLUSH 1024
+
 	class MoveEvent;
 
 	class MoveEventScript : public LuaInterface {
@@ -75,6 +82,35 @@
 				EventList moveEvent[MOVE_EVENT_NONE];
 			};
 
+			// events by key plus a bitset of hashed keys, a clear bit means there
+			// is nothing registered for that key and the map is never searched
+			template<class Map>
+			struct MoveIndex {
+				typedef typename Map::key_type Key;
+				typedef typename Map::iterator iterator;
+
+				void add(const Key& key) {
+					filter.set(getFilterIndex(key));
+				}
+				bool mayContain(const Key& key) const {
+					return filter.test(getFilterIndex(key));
+				}
+				void clear() {
+					events.clear();
+					filter.reset();
+				}
+
+				Map events;
+				std::bitset<MOVE_FILTER_SIZE> filter;
+			};
+
+			static uint32_t getFilterIndex(int32_t id) {
+				return id & MOVE_FILTER_MASK;
+			}
+			static uint32_t getFilterIndex(const Position& pos) {
+				return ((uint32_t)pos.x * 73856093U ^ (uint32_t)pos.y * 19349663U ^ (uint32_t)pos.z * 83492791U) & MOVE_FILTER_MASK;
+			}
+
 			virtual std::string getScriptBaseName() const {
 				return "movements";
 			}
@@ -92,14 +128,18 @@
 			void registerActionID(int32_t actionId, MoveEvent_t eventType);
 			void registerUniqueID(int32_t uniqueId, MoveEvent_t eventType);
 
-			typedef std::map<int32_t, MoveEventList> MoveListMap;
+			typedef MoveIndex<std::tr1::unordered_map<int32_t, MoveEventList> > MoveListMap;
 			MoveListMap m_itemIdMap;
 			MoveListMap m_uniqueIdMap;
 			MoveListMap m_actionIdMap;
 
-			typedef std::map<Position, MoveEventList> MovePosListMap;
+			typedef MoveIndex<std::map<Position, MoveEventList> > MovePosListMap;
 			MovePosListMap m_positionMap;
-			void clearMap(MoveListMap& map);
+
+			template<class Index>
+			void clearMap(Index& map);
+			template<class Index>
+			MoveEventList* findEvents(Index& map, const typename Index::Key& key);
 
 			void addEvent(MoveEvent* moveEvent, int32_t id, MoveListMap& map, bool override);
 			MoveEvent* getEvent(Item* item, MoveEvent_t eventType, slots_t slot);
@@ -107,6 +147,9 @@
 			void addEvent(MoveEvent* moveEvent, Position pos, MovePosListMap& map, bool override);
 			MoveEvent* getEvent(const Tile* tile, MoveEvent_t eventType);
 
+			// lookups answered by the filters, flushed to the metrics in batches
+			uint32_t m_lookups, m_lookupsSkipped;
+
 			const Tile* m_lastCacheTile;
 			std::vector<Item*> m_lastCacheItemVector;
 	};
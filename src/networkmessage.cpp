@@ -166,6 +166,16 @@ void NetworkMessage::putString(const char* value, bool addSize) {
 	m_size += size;
 }
 
+void NetworkMessage::putBytes(const char* bytes, uint32_t size) {
+	if (!hasSpace(size)) {
+		return;
+	}
+
+	memcpy(m_buffer + m_position, bytes, size);
+	m_position += size;
+	m_size += size;
+}
+
 void NetworkMessage::putPadding(uint32_t amount) {
 	if (!hasSpace(amount)) {
 		return;
@@ -192,13 +202,23 @@ void NetworkMessage::putItem(uint16_t id, uint8_t count) {
 }
 
 void NetworkMessage::putItem(const Item* item) {
+	char buffer[NETWORKMESSAGE_ITEM_MAXSIZE];
+	putBytes(buffer, encodeItem(item, buffer));
+}
+
+uint32_t NetworkMessage::encodeItem(const Item* item, char* buffer) {
 	const ItemType& it = Item::items[item->getID()];
-	put<uint16_t>(it.clientId);
+	*(uint16_t*)buffer = it.clientId;
 	if (it.stackable) {
-		put<char>(item->getSubType());
-	} else if (it.isSplash() || it.isFluidContainer()) {
-		put<char>(fluidMap[item->getSubType() % 8]);
+		buffer[2] = item->getSubType();
+		return 3;
+	}
+
+	if (it.isSplash() || it.isFluidContainer()) {
+		buffer[2] = fluidMap[item->getSubType() % 8];
+		return 3;
 	}
+	return 2;
 }
 
 void NetworkMessage::putItemId(const Item* item) {
@@ -30,6 +30,9 @@
 	class Item;
 	class Position;
 
+	// most bytes a single item takes in an outgoing message
+	#define NETWORKMESSAGE_ITEM_MAXSIZE 3
+
 	class NetworkMessage {
 		public:
 			NetworkMessage() {
@@ -88,6 +91,7 @@
 				putString(value.c_str(), addSize);
 			}
 			void putString(const char* value, bool addSize = true);
+			void putBytes(const char* bytes, uint32_t size);
 
 			void putPadding(uint32_t amount);
 
@@ -98,6 +102,9 @@
 			void putItemId(const Item* item);
 			void putItemId(uint16_t itemId);
 
+			// writes what putItem would into buffer, returns the byte count
+			static uint32_t encodeItem(const Item* item, char* buffer);
+
 			int32_t decodeHeader();
 
 			// message propeties functions
@@ -143,4 +150,6 @@
 	};
 
 	typedef boost::shared_ptr<NetworkMessage> NetworkMessage_ptr;
+	// encoded packet bytes shared by every connection they are appended to
+	typedef boost::shared_ptr<const std::string> NetworkFragment_ptr;
 #endif
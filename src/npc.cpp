@@ -38,6 +38,7 @@
 extern ConfigManager g_config;
 extern Game g_game;
 extern Spells* g_spells;
+extern Npcs g_npcs;
 
 AutoList<Npc> Npc::autoList;
 
@@ -52,6 +53,8 @@ void Npcs::reload() {
 		it->second->closeAllShopWindows();
 	}
 
+	// npcs still hold their current types until the new ones are in place
+	types.clear();
 	delete Npc::m_interface;
 	Npc::m_interface = NULL;
 	for (AutoList<Npc>::iterator it = Npc::autoList.begin(); it != Npc::autoList.end(); ++it) {
@@ -59,6 +62,23 @@ void Npcs::reload() {
 	}
 }
 
+NpcType_ptr Npcs::getType(const std::string& filename) {
+	TypeMap::iterator it = types.find(filename);
+	if (it != types.end()) {
+		return it->second;
+	}
+
+	NpcType* npcType = new NpcType();
+	if (!npcType->loadFromXml(filename)) {
+		delete npcType;
+		return NpcType_ptr();
+	}
+
+	NpcType_ptr type(npcType);
+	types[filename] = type;
+	return type;
+}
+
 Npc* Npc::createNpc(const std::string& name) {
 	Npc* npc = new Npc(name);
 	if (!npc) {
@@ -112,43 +132,58 @@ bool Npc::load() {
 		m_interface->loadFile(getFilePath(FILE_TYPE_OTHER, "npc/lib/npcsystem/main.lua"));
 	}
 
-	loaded = loadFromXml(m_filename);
+	NpcType_ptr newType = g_npcs.getType(m_filename);
+	if (newType) {
+		npcType = newType;
+	} else if (npcType) {
+		std::clog << "[Warning - Npc::load] NPC Name: " << name << " - Keeping the previously loaded definition." << std::endl;
+	} else {
+		return false;
+	}
+
+	applyType();
+	if (npcType->scriptFile.empty()) {
+		loaded = true;
+		return true;
+	}
+
+	m_npcEventHandler = new NpcEvents(npcType->scriptFile, this);
+	loaded = m_npcEventHandler->isLoaded();
 	return isLoaded();
 }
 
+void Npc::applyType() {
+	name = npcType->name;
+	nameDescription = npcType->nameDescription;
+	hideName = npcType->hideName;
+	hideHealth = npcType->hideHealth;
+	baseSpeed = npcType->baseSpeed;
+	health = npcType->health;
+	healthMax = npcType->healthMax;
+
+	defaultOutfit = currentOutfit = npcType->outfit;
+	setSkull(npcType->skull);
+	setShield(npcType->shield);
+	setEmblem(npcType->emblem);
+}
+
 void Npc::reset() {
 	loaded = false;
-	walkTicks = 1500;
-	floorChange = false;
-	attackable = false;
-	hasBusyReply = false;
 	hasScriptedFocus = false;
 	focusCreature = 0;
 	isIdle = true;
-	talkRadius = 2;
-	idleTime = 0;
-	idleInterval = 5 * 60;
 	lastVoice = OTSYS_TIME();
-	defaultPublic = true;
 
 	delete m_npcEventHandler;
 	m_npcEventHandler = NULL;
-	for (ResponseList::iterator it = responseList.begin(); it != responseList.end(); ++it) {
-		delete *it;
-	}
-
 	for (StateList::iterator it = stateList.begin(); it != stateList.end(); ++it) {
 		delete *it;
 	}
 
-	responseList.clear();
 	stateList.clear();
 	queueList.clear();
-	m_parameters.clear();
-	itemListMap.clear();
 	responseScriptMap.clear();
 	shopPlayerList.clear();
-	voiceList.clear();
 }
 
 void Npc::reload() {
@@ -159,22 +194,43 @@ void Npc::reload() {
 		m_npcEventHandler->onCreatureAppear(this);
 	}
 
-	if (walkTicks > 0) {
+	if (npcType && npcType->walkTicks > 0) {
 		addEventWalk();
 	}
 }
 
-bool Npc::loadFromXml(const std::string& filename) {
+NpcType::NpcType() {
+	walkTicks = 1500;
+	talkRadius = 2;
+	idleTime = 0;
+	idleInterval = 5 * 60;
+	baseSpeed = 110;
+	health = healthMax = 1000;
+	floorChange = attackable = walkable = hasBusyReply = hideName = hideHealth = false;
+	defaultPublic = true;
+
+	skull = SKULL_NONE;
+	shield = SHIELD_NONE;
+	emblem = EMBLEM_NONE;
+}
+
+NpcType::~NpcType() {
+	for (ResponseList::iterator it = responseList.begin(); it != responseList.end(); ++it) {
+		delete *it;
+	}
+}
+
+bool NpcType::loadFromXml(const std::string& filename) {
 	xmlDocPtr doc = xmlParseFile(filename.c_str());
 	if (!doc) {
-		std::clog << "[Warning - Npc::loadFromXml] Cannot load npc file (" << filename << ")." << std::endl;
+		std::clog << "[Warning - NpcType::loadFromXml] Cannot load npc file (" << filename << ")." << std::endl;
 		std::clog << getLastXMLError() << std::endl;
 		return false;
 	}
 
 	xmlNodePtr p, root = xmlDocGetRootElement(doc);
 	if (xmlStrcmp(root->name,(const xmlChar*)"npc")) {
-		std::clog << "[Error - Npc::loadFromXml] Malformed npc file (" << filename << ")." << std::endl;
+		std::clog << "[Error - NpcType::loadFromXml] Malformed npc file (" << filename << ")." << std::endl;
 		xmlFreeDoc(doc);
 		return false;
 	}
@@ -202,7 +258,6 @@ bool Npc::loadFromXml(const std::string& filename) {
 		hideHealth = booleanString(strValue);
 	}
 
-	baseSpeed = 110;
 	if (readXMLInteger(root, "speed", intValue)) {
 		baseSpeed = intValue;
 	}
@@ -229,15 +284,15 @@ bool Npc::loadFromXml(const std::string& filename) {
 	}
 
 	if (readXMLString(root, "skull", strValue)) {
-		setSkull(getSkulls(strValue));
+		skull = getSkulls(strValue);
 	}
 
 	if (readXMLString(root, "shield", strValue)) {
-		setShield(getShields(strValue));
+		shield = getShields(strValue);
 	}
 
 	if (readXMLString(root, "emblem", strValue)) {
-		setEmblem(getEmblems(strValue));
+		emblem = getEmblems(strValue);
 	}
 
 	p = root->children;
@@ -256,30 +311,29 @@ bool Npc::loadFromXml(const std::string& filename) {
 			}
 		} else if (xmlStrcmp(p->name, (const xmlChar*)"look") == 0) {
 			if (readXMLInteger(p, "type", intValue)) {
-				defaultOutfit.lookType = intValue;
+				outfit.lookType = intValue;
 				if (readXMLInteger(p, "head", intValue)) {
-					defaultOutfit.lookHead = intValue;
+					outfit.lookHead = intValue;
 				}
 
 				if (readXMLInteger(p, "body", intValue)) {
-					defaultOutfit.lookBody = intValue;
+					outfit.lookBody = intValue;
 				}
 
 				if (readXMLInteger(p, "legs", intValue)) {
-					defaultOutfit.lookLegs = intValue;
+					outfit.lookLegs = intValue;
 				}
 
 				if (readXMLInteger(p, "feet", intValue)) {
-					defaultOutfit.lookFeet = intValue;
+					outfit.lookFeet = intValue;
 				}
 
 				if (readXMLInteger(p, "addons", intValue)) {
-					defaultOutfit.lookAddons = intValue;
+					outfit.lookAddons = intValue;
 				}
 			} else if (readXMLInteger(p, "typeex", intValue)) {
-				defaultOutfit.lookTypeEx = intValue;
+				outfit.lookTypeEx = intValue;
 			}
-			currentOutfit = defaultOutfit;
 		} else if (xmlStrcmp(p->name, (const xmlChar*)"voices") == 0) {
 			for (xmlNodePtr q = p->children; q != NULL; q = q->next) {
 				if (xmlStrcmp(q->name, (const xmlChar*)"voice") == 0) {
@@ -328,7 +382,7 @@ bool Npc::loadFromXml(const std::string& filename) {
 						continue;
 					}
 
-					m_parameters[paramKey] = paramValue;
+					parameters[paramKey] = paramValue;
 				}
 			}
 		} else if (xmlStrcmp(p->name, (const xmlChar*)"interaction") == 0) {
@@ -348,6 +402,7 @@ bool Npc::loadFromXml(const std::string& filename) {
 				defaultPublic = intValue != 0;
 			}
 			responseList = loadInteraction(p->children);
+			responseMatcher.compile(responseList);
 		}
 		p = p->next;
 	}
@@ -363,11 +418,11 @@ bool Npc::loadFromXml(const std::string& filename) {
 		scriptfile = getFilePath(FILE_TYPE_OTHER, "npc/scripts/" + scriptfile);
 	}
 
-	m_npcEventHandler = new NpcEvents(scriptfile, this);
-	return m_npcEventHandler->isLoaded();
+	scriptFile = scriptfile;
+	return true;
 }
 
-uint32_t Npc::loadParams(xmlNodePtr node) {
+uint32_t NpcType::loadParams(xmlNodePtr node) {
 	std::string strValue;
 	uint32_t params = RESPOND_DEFAULT;
 	if (readXMLString(node, "param", strValue)) {
@@ -399,14 +454,14 @@ uint32_t Npc::loadParams(xmlNodePtr node) {
 			} else if (tmpParam == "lowlevel") {
 				params |= RESPOND_LOWLEVEL;
 			} else {
-				std::clog << "[Warning - Npc::loadParams] NPC Name: " << name << " - Unknown param " << (*it) << std::endl;
+				std::clog << "[Warning - NpcType::loadParams] NPC Name: " << name << " - Unknown param " << (*it) << std::endl;
 			}
 		}
 	}
 	return params;
 }
 
-ResponseList Npc::loadInteraction(xmlNodePtr node) {
+ResponseList NpcType::loadInteraction(xmlNodePtr node) {
 	std::string strValue;
 	int32_t intValue;
 
@@ -420,11 +475,11 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 						ResponseList includedResponses = loadInteraction(root->children);
 						_responseList.insert(_responseList.end(), includedResponses.begin(), includedResponses.end());
 					} else {
-						std::clog << "[Error - Npc::loadInteraction] Malformed interaction file (" << strValue << ")." << std::endl;
+						std::clog << "[Error - NpcType::loadInteraction] Malformed interaction file (" << strValue << ")." << std::endl;
 					}
 					xmlFreeDoc(doc);
 				} else {
-					std::clog << "[Warning - Npc::loadInteraction] Cannot load interaction file (" << strValue << ")." << std::endl;
+					std::clog << "[Warning - NpcType::loadInteraction] Cannot load interaction file (" << strValue << ")." << std::endl;
 					std::clog << getLastXMLError() << std::endl;
 				}
 			}
@@ -440,7 +495,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 						if (!xmlStrcmp(tmpNode->name, (const xmlChar*)"item")) {
 							ListItem li;
 							if (!readXMLInteger(tmpNode, "id", intValue)) {
-								std::clog << "[Warning - Npc::loadInteraction] NPC Name: " << name << " - Missing list item itemId" << std::endl;
+								std::clog << "[Warning - NpcType::loadInteraction] NPC Name: " << name << " - Missing list item itemId" << std::endl;
 								tmpNode = tmpNode->next;
 								continue;
 							}
@@ -459,7 +514,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 							if (readXMLString(tmpNode, "keywords", strValue)) {
 								li.keywords = strValue;
 							} else {
-								std::clog << "[Warning - Npc::loadInteraction] NPC Name: " << name << " - Missing list item keywords" << std::endl;
+								std::clog << "[Warning - NpcType::loadInteraction] NPC Name: " << name << " - Missing list item keywords" << std::endl;
 								tmpNode = tmpNode->next;
 								continue;
 							}
@@ -488,7 +543,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 						tmpNode = tmpNode->next;
 					}
 				} else {
-					std::clog << "[Warning - Npc::loadInteraction] NPC Name: " << name << " - Duplicate listId found: " << strValue << std::endl;
+					std::clog << "[Warning - NpcType::loadInteraction] NPC Name: " << name << " - Duplicate listId found: " << strValue << std::endl;
 				}
 			}
 		} else if (!xmlStrcmp(node->name, (const xmlChar*)"interact")) {
@@ -572,7 +627,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 								if (it != itemListMap.end()) {
 									prop.itemList.insert(prop.itemList.end(), it->second.begin(), it->second.end());
 								} else {
-									std::clog << "[Warning - Npc::loadInteraction] NPC Name: " << name << " - Could not find a list id called: " << strValue << std::endl;
+									std::clog << "[Warning - NpcType::loadInteraction] NPC Name: " << name << " - Could not find a list id called: " << strValue << std::endl;
 								}
 							}
 						}
@@ -656,7 +711,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 										action.actionType = ACTION_SETSPELL;
 										action.strValue = strValue;
 										if (strValue != "|SPELL|" && !g_spells->getInstantSpellByName(strValue)) {
-											std::clog << "[Warning - Npc::loadInteraction] NPC Name: " << name << " - Could not find an instant spell called: " << strValue << std::endl;
+											std::clog << "[Warning - NpcType::loadInteraction] NPC Name: " << name << " - Could not find an instant spell called: " << strValue << std::endl;
 										}
 									}
 								} else if (tmpStrValue == "listname") {
@@ -674,7 +729,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 										action.actionType = ACTION_TEACHSPELL;
 										action.strValue = strValue;
 										if (strValue != "|SPELL|" && !g_spells->getInstantSpellByName(strValue)) {
-											std::clog << "[Warning - Npc::loadInteraction] NPC Name: " << name << " - Could not find an instant spell called: " << strValue << std::endl;
+											std::clog << "[Warning - NpcType::loadInteraction] NPC Name: " << name << " - Could not find an instant spell called: " << strValue << std::endl;
 										}
 									}
 								} else if (tmpStrValue == "unteachspell") {
@@ -682,7 +737,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 										action.actionType = ACTION_UNTEACHSPELL;
 										action.strValue = strValue;
 										if (strValue != "|SPELL|" && !g_spells->getInstantSpellByName(strValue)) {
-											std::clog << "[Warning - Npc::loadInteraction] NPC Name: " << name << " - Could not find an instant spell called: " << strValue << std::endl;
+											std::clog << "[Warning - NpcType::loadInteraction] NPC Name: " << name << " - Could not find an instant spell called: " << strValue << std::endl;
 										}
 									}
 								} else if (tmpStrValue == "sell") {
@@ -778,7 +833,7 @@ ResponseList Npc::loadInteraction(xmlNodePtr node) {
 										}
 									}
 								} else {
-									std::clog << "[Warning - Npc::loadInteraction] Unknown action " << strValue << std::endl;
+									std::clog << "[Warning - NpcType::loadInteraction] Unknown action " << strValue << std::endl;
 								}
 							}
 
@@ -931,7 +986,7 @@ bool Npc::canSee(const Position& pos) const {
 void Npc::onCreatureAppear(const Creature* creature) {
 	Creature::onCreatureAppear(creature);
 	if (creature == this) {
-		if (walkTicks > 0) {
+		if (npcType->walkTicks > 0) {
 			addEventWalk();
 		}
 
@@ -1010,7 +1065,7 @@ void Npc::onCreatureSay(const Creature* creature, SpeakClasses type, const std::
 			}
 
 			const Position& myPos = getPosition();
-			if (canSee(myPos) && (destPos.x >= myPos.x - talkRadius) && (destPos.x <= myPos.x + talkRadius) && (destPos.y >= myPos.y - talkRadius) && (destPos.y <= myPos.y + talkRadius)) {
+			if (canSee(myPos) && (destPos.x >= myPos.x - npcType->talkRadius) && (destPos.x <= myPos.x + npcType->talkRadius) && (destPos.y >= myPos.y - npcType->talkRadius) && (destPos.y <= myPos.y + npcType->talkRadius)) {
 				if (NpcState* npcState = getState(player)) {
 					npcState->respondToText = text;
 					npcState->respondToCreature = player->getID();
@@ -1057,7 +1112,7 @@ void Npc::onThink(uint32_t interval) {
 
 	if (list.size()) { // loop only if there's at least one player
 		int64_t now = OTSYS_TIME();
-		for (VoiceList::iterator it = voiceList.begin(); it != voiceList.end(); ++it) {
+		for (NpcType::VoiceList::const_iterator it = npcType->voiceList.begin(); it != npcType->voiceList.end(); ++it) {
 			if (now < (lastVoice + it->margin)) {
 				continue;
 			}
@@ -1081,11 +1136,11 @@ void Npc::onThink(uint32_t interval) {
 	}
 
 	bool idleResponse = false;
-	if ((uint32_t)(MAX_RAND_RANGE / idleInterval) >= (uint32_t)random_range(0, MAX_RAND_RANGE)) {
+	if ((uint32_t)(MAX_RAND_RANGE / npcType->idleInterval) >= (uint32_t)random_range(0, MAX_RAND_RANGE)) {
 		idleResponse = true;
 	}
 
-	if (getTimeSinceLastMove() >= walkTicks) {
+	if (getTimeSinceLastMove() >= npcType->walkTicks) {
 		addEventWalk();
 	}
 
@@ -1103,7 +1158,7 @@ void Npc::onThink(uint32_t interval) {
 
 			if (!queueList.empty() && npcState->isIdle && npcState->respondToText.empty()) {
 				closeConversation = true;
-			} else if (idleTime > 0 && (OTSYS_TIME() - npcState->prevInteraction) > (uint64_t)(idleTime * 1000)) {
+			} else if (npcType->idleTime > 0 && (OTSYS_TIME() - npcState->prevInteraction) > (uint64_t)(npcType->idleTime * 1000)) {
 				idleTimeout = closeConversation = true;
 			}
 		}
@@ -1139,7 +1194,7 @@ void Npc::onThink(uint32_t interval) {
 		}
 
 		if (!npcState->respondToText.empty()) {
-			if (hasBusyReply && !isIdle) {
+			if (npcType->hasBusyReply && !isIdle) {
 				// Check if we have a busy reply
 				if ((response = getResponse(player, npcState, EVENT_BUSY))) {
 					executeResponse(player, npcState, response);
@@ -1147,8 +1202,8 @@ void Npc::onThink(uint32_t interval) {
 			} else {
 				if (npcState->lastResponse) {
 					// Check previous response chain first
-					const ResponseList& list = npcState->lastResponse->getResponseList();
-					response = getResponse(list, player, npcState, npcState->respondToText);
+					const ResponseMatcher& matcher = npcState->lastResponse->getResponseMatcher();
+					response = getResponse(matcher, player, npcState, npcState->respondToText);
 				}
 
 				if (!response) {
@@ -1169,7 +1224,7 @@ void Npc::onThink(uint32_t interval) {
 		executeResponse(player, npcState, response);
 		if (!npcState->isIdle) {
 			isIdle = false;
-			if (hasBusyReply) {
+			if (npcType->hasBusyReply) {
 				setCreatureFocus(player);
 			}
 		}
@@ -1473,8 +1528,8 @@ void Npc::executeResponse(Player* player, NpcState* npcState, const NpcResponse*
 						scriptstream << "local cid = " << env->addThing(player) << std::endl;
 						scriptstream << "local text = \"" << npcState->respondToText << "\"" << std::endl;
 						scriptstream << "local name = \"" << player->getName() << "\"" << std::endl;
-						scriptstream << "local idletime = " << idleTime << std::endl;
-						scriptstream << "local idleinterval = " << idleInterval << std::endl;
+						scriptstream << "local idletime = " << npcType->idleTime << std::endl;
+						scriptstream << "local idleinterval = " << npcType->idleInterval << std::endl;
 
 						scriptstream << "local itemlist = {" << std::endl;
 						uint32_t n = 0;
@@ -1614,9 +1669,9 @@ void Npc::doSay(const std::string& text, SpeakClasses type, Player* player) {
 }
 
 uint32_t Npc::getListItemPrice(uint16_t itemId, ShopEvent_t type) {
-	for (ItemListMap::iterator it = itemListMap.begin(); it != itemListMap.end(); ++it) {
-		std::list<ListItem>& itemList = it->second;
-		for (std::list<ListItem>::iterator iit = itemList.begin(); iit != itemList.end(); ++iit) {
+	for (NpcType::ItemListMap::const_iterator it = npcType->itemListMap.begin(); it != npcType->itemListMap.end(); ++it) {
+		const std::list<ListItem>& itemList = it->second;
+		for (std::list<ListItem>::const_iterator iit = itemList.begin(); iit != itemList.end(); ++iit) {
 			if ((*iit).itemId == itemId) {
 				if (type == SHOPEVENT_BUY) {
 					return (*iit).buyPrice;
@@ -1687,7 +1742,7 @@ bool Npc::getNextStep(Direction& dir, uint32_t& flags) {
 		return true;
 	}
 
-	if (walkTicks <= 0 || !isIdle || focusCreature || getTimeSinceLastMove() < walkTicks) {
+	if (npcType->walkTicks <= 0 || !isIdle || focusCreature || getTimeSinceLastMove() < npcType->walkTicks) {
 		return false;
 	}
 	return getRandomStep(dir);
@@ -1704,7 +1759,7 @@ bool Npc::canWalkTo(const Position& fromPos, Direction dir) {
 	}
 
 	Tile* tile = g_game.getTile(toPos);
-	if (!tile || g_game.isSwimmingPool(NULL, getTile(), false) != g_game.isSwimmingPool(NULL, tile, false) || (!floorChange && (tile->floorChange() || tile->positionChange()))) {
+	if (!tile || g_game.isSwimmingPool(NULL, getTile(), false) != g_game.isSwimmingPool(NULL, tile, false) || (!npcType->floorChange && (tile->floorChange() || tile->positionChange()))) {
 		return false;
 	}
 	return tile->__queryAdd(0, this, 1, FLAG_PATHFINDING) == RET_NOERROR;
@@ -1757,13 +1812,131 @@ void Npc::setCreatureFocus(Creature* creature) {
 	g_game.internalCreatureTurn(this, dir);
 }
 
-const NpcResponse* Npc::getResponse(const ResponseList& list, const Player* player, NpcState* npcState, const std::string& text, bool exactMatch) {
+static size_t getKeywordStart(const std::string& word) {
+	// keywords are matched from the first punctuation mark of a word, if any
+	size_t pos = word.find_first_of("!\"#�%&/()=?`{[]}\\^*><,.-_~");
+	if (pos == std::string::npos) {
+		return 0;
+	}
+	return pos;
+}
+
+void ResponseMatcher::clear() {
+	events.clear();
+	responses.clear();
+	nodes.clear();
+	wildcards.clear();
+}
+
+void ResponseMatcher::compile(const ResponseList& list) {
+	clear();
+	nodes.push_back(Node());
+	for (ResponseList::const_iterator it = list.begin(); it != list.end(); ++it) {
+		uint32_t index = responses.size();
+		responses.push_back(*it);
+		if ((*it)->getInteractType() == INTERACT_EVENT) {
+			events[(*it)->getInputText()].push_back(index);
+			continue;
+		}
+
+		if ((*it)->getInteractType() != INTERACT_TEXT) {
+			wildcards.push_back(index);
+			continue;
+		}
+
+		bool wildcard = false;
+		const std::list<std::string>& inputList = (*it)->getInputList();
+		for (std::list<std::string>::const_iterator iit = inputList.begin(); !wildcard && iit != inputList.end(); ++iit) {
+			StringVec keywordList = explodeString(*iit, ";");
+			for (StringVec::iterator kit = keywordList.begin(); kit != keywordList.end(); ++kit) {
+				if (kit->empty() || (*kit) == "|*|" || asLowerCaseString(*kit) == "|amount|") {
+					wildcard = true;
+					break;
+				}
+				addKeyword(*kit, index);
+			}
+		}
+
+		if (wildcard) {
+			wildcards.push_back(index);
+		}
+	}
+}
+
+void ResponseMatcher::addKeyword(const std::string& keyword, uint32_t index) {
+	uint32_t node = 0;
+	for (std::string::const_iterator it = keyword.begin(); it != keyword.end(); ++it) {
+		std::map<char, uint32_t>::iterator cit = nodes[node].children.find(*it);
+		if (cit != nodes[node].children.end()) {
+			node = cit->second;
+			continue;
+		}
+
+		uint32_t child = nodes.size();
+		nodes[node].children[*it] = child;
+		nodes.push_back(Node());
+		node = child;
+	}
+
+	std::vector<uint32_t>& list = nodes[node].responses;
+	if (list.empty() || list.back() != index) {
+		list.push_back(index);
+	}
+}
+
+void ResponseMatcher::getCandidates(const std::string& text, const StringVec& wordList, ResponseVector& candidates) const {
+	std::vector<uint32_t> indexes = wildcards;
+	EventMap::const_iterator eit = events.find(text);
+	if (eit != events.end()) {
+		indexes.insert(indexes.end(), eit->second.begin(), eit->second.end());
+	}
+
+	if (!nodes.empty()) {
+		for (StringVec::const_iterator wit = wordList.begin(); wit != wordList.end(); ++wit) {
+			// every node on the path ends a keyword which is a prefix of the word
+			uint32_t node = 0;
+			for (size_t i = getKeywordStart(*wit); i < wit->size(); ++i) {
+				std::map<char, uint32_t>::const_iterator cit = nodes[node].children.find((*wit)[i]);
+				if (cit == nodes[node].children.end()) {
+					break;
+				}
+
+				node = cit->second;
+				indexes.insert(indexes.end(), nodes[node].responses.begin(), nodes[node].responses.end());
+			}
+		}
+	}
+
+	// keep the list order, ties between responses depend on it
+	std::sort(indexes.begin(), indexes.end());
+	indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+	for (std::vector<uint32_t>::iterator it = indexes.begin(); it != indexes.end(); ++it) {
+		candidates.push_back(responses[*it]);
+	}
+}
+
+void ResponseMatcher::getEventResponses(const std::string& eventName, ResponseVector& result) const {
+	EventMap::const_iterator it = events.find(eventName);
+	if (it == events.end()) {
+		return;
+	}
+
+	for (std::vector<uint32_t>::const_iterator iit = it->second.begin(); iit != it->second.end(); ++iit) {
+		result.push_back(responses[*iit]);
+	}
+}
+
+const NpcResponse* Npc::getResponse(const ResponseMatcher& matcher, const Player* player, NpcState* npcState, const std::string& text, bool exactMatch) {
 	std::string textString = asLowerCaseString(text);
 	StringVec wordList = explodeString(textString, " ");
 	int32_t bestMatchCount = 0, totalMatchCount = 0;
 
+	// responses without a keyword matching the text can not score, so skip them
+	ResponseVector list;
+	matcher.getCandidates(textString, wordList, list);
+
 	NpcResponse* response = NULL;
-	for (ResponseList::const_iterator it = list.begin(); it != list.end(); ++it) {
+	for (ResponseVector::const_iterator it = list.begin(); it != list.end(); ++it) {
 		int32_t matchCount = 0;
 		if ((*it)->getParams() != RESPOND_DEFAULT) {
 			uint32_t params = (*it)->getParams();
@@ -2020,12 +2193,12 @@ const NpcResponse* Npc::getResponse(const ResponseList& list, const Player* play
 	return response;
 }
 
-uint32_t Npc::getMatchCount(NpcResponse* response, StringVec wordList, bool exactMatch, int32_t& matchAllCount, int32_t& totalKeywordCount) {
+uint32_t Npc::getMatchCount(NpcResponse* response, const StringVec& wordList, bool exactMatch, int32_t& matchAllCount, int32_t& totalKeywordCount) {
 	int32_t bestMatchCount = matchAllCount = totalKeywordCount = 0;
 	const std::list<std::string>& inputList = response->getInputList();
 	for (std::list<std::string>::const_iterator it = inputList.begin(); it != inputList.end(); ++it) {
 		std::string keywords = (*it), tmpKit;
-		StringVec::iterator lastWordMatch = wordList.begin();
+		StringVec::const_iterator lastWordMatch = wordList.begin();
 
 		int32_t matchCount = 0;
 		StringVec keywordList = explodeString(keywords, ";");
@@ -2042,13 +2215,9 @@ uint32_t Npc::getMatchCount(NpcResponse* response, StringVec wordList, bool exac
 				}
 				response->setAmount(amount);
 			} else {
-				StringVec::iterator wit = wordList.end();
+				StringVec::const_iterator wit = wordList.end();
 				for (wit = lastWordMatch; wit != wordList.end(); ++wit) {
-					size_t pos = (*wit).find_first_of("!\"#�%&/()=?`{[]}\\^*><,.-_~");
-					if (pos == std::string::npos) {
-						pos = 0;
-					}
-
+					size_t pos = getKeywordStart(*wit);
 					if ((*wit).find((*kit), pos) == pos) {
 						break;
 					}
@@ -2075,7 +2244,7 @@ uint32_t Npc::getMatchCount(NpcResponse* response, StringVec wordList, bool exac
 }
 
 const NpcResponse* Npc::getResponse(const Player* player, NpcState* npcState, const std::string& text) {
-	return getResponse(responseList, player, npcState, text);
+	return getResponse(npcType->responseMatcher, player, npcState, text);
 }
 
 const NpcResponse* Npc::getResponse(const Player*, NpcEvent_t eventType) {
@@ -2084,14 +2253,8 @@ const NpcResponse* Npc::getResponse(const Player*, NpcEvent_t eventType) {
 		return NULL;
 	}
 
-	std::vector<NpcResponse*> result;
-	for (ResponseList::const_iterator it = responseList.begin(); it != responseList.end(); ++it) {
-		if ((*it)->getInteractType() == INTERACT_EVENT) {
-			if ((*it)->getInputText() == asLowerCaseString(eventName)) {
-				result.push_back(*it);
-			}
-		}
-	}
+	ResponseVector result;
+	npcType->responseMatcher.getEventResponses(asLowerCaseString(eventName), result);
 
 	if (result.empty()) {
 		return NULL;
@@ -2104,7 +2267,7 @@ const NpcResponse* Npc::getResponse(const Player* player, NpcState* npcState, Np
 	if (eventName.empty()) {
 		return NULL;
 	}
-	return getResponse(responseList, player, npcState, eventName, true);
+	return getResponse(npcType->responseMatcher, player, npcState, eventName, true);
 }
 
 std::string Npc::getEventResponseName(NpcEvent_t eventType) {
@@ -2313,8 +2476,8 @@ int32_t NpcScript::luaGetNpcParameter(lua_State* L) {
 	// getNpcParameter(key)
 	ScriptEnviroment* env = getEnv();
 	if (Npc* npc = env->getNpc()) {
-		Npc::ParametersMap::iterator it = npc->m_parameters.find(popString(L));
-		if (it != npc->m_parameters.end()) {
+		NpcType::ParametersMap::const_iterator it = npc->npcType->parameters.find(popString(L));
+		if (it != npc->npcType->parameters.end()) {
 			lua_pushstring(L, it->second.c_str());
 		} else {
 			lua_pushnil(L);
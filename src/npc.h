@@ -26,12 +26,20 @@
 	class Npc;
 	typedef std::list<Npc*> NpcList;
 
+	class NpcType;
+	typedef boost::shared_ptr<const NpcType> NpcType_ptr;
+
 	class Npcs {
 		public:
 			Npcs() {}
 			virtual ~Npcs() {}
 
 			void reload();
+			NpcType_ptr getType(const std::string& filename);
+
+		protected:
+			typedef std::map<std::string, NpcType_ptr> TypeMap;
+			TypeMap types;
 	};
 
 	class NpcState;
@@ -216,6 +224,37 @@
 
 	class NpcResponse;
 	typedef std::list<NpcResponse*> ResponseList;
+	typedef std::vector<NpcResponse*> ResponseVector;
+
+	// keyword trie of a response list, built at load time so that a line of text
+	// only evaluates the responses which have a keyword matching one of its words
+	class ResponseMatcher {
+		public:
+			ResponseMatcher() {}
+			virtual ~ResponseMatcher() {}
+
+			void compile(const ResponseList& list);
+			void clear();
+
+			void getCandidates(const std::string& text, const StringVec& wordList, ResponseVector& candidates) const;
+			void getEventResponses(const std::string& eventName, ResponseVector& result) const;
+
+		protected:
+			struct Node {
+				std::map<char, uint32_t> children;
+				std::vector<uint32_t> responses;
+			};
+
+			void addKeyword(const std::string& keyword, uint32_t index);
+
+			typedef std::map<std::string, std::vector<uint32_t> > EventMap;
+			EventMap events;
+
+			ResponseVector responses;
+			std::vector<Node> nodes;
+			// responses which may match any text (|*|, |amount|, empty keywords)
+			std::vector<uint32_t> wildcards;
+	};
 
 	typedef std::map<std::string, int32_t> ResponseScriptMap;
 
@@ -247,6 +286,7 @@
 				prop = _prop;
 				subResponseList = _subResponseList;
 				scriptVars = _scriptVars;
+				matcher.compile(subResponseList);
 			}
 
 			NpcResponse(NpcResponse& rhs) {
@@ -256,6 +296,7 @@
 					NpcResponse* response = new NpcResponse(*(*it));
 					subResponseList.push_back(response);
 				}
+				matcher.compile(subResponseList);
 			}
 
 			virtual ~NpcResponse() {
@@ -318,10 +359,14 @@
 
 			void setResponseList(ResponseList _list) {
 				subResponseList.insert(subResponseList.end(), _list.begin(), _list.end());
+				matcher.compile(subResponseList);
 			}
 			const ResponseList& getResponseList() const {
 				return subResponseList;
 			}
+			const ResponseMatcher& getResponseMatcher() const {
+				return matcher;
+			}
 
 			ActionList::const_iterator getFirstAction() const {
 				return prop.actionList.begin();
@@ -332,6 +377,7 @@
 
 			ResponseProperties prop;
 			ResponseList subResponseList;
+			ResponseMatcher matcher;
 			ScriptVars scriptVars;
 	};
 
@@ -355,6 +401,44 @@
 
 	#define MAX_RAND_RANGE 10000000
 
+	// everything read from an npc file, shared by all npcs of that file and never
+	// changed once loaded; reloading parses a new type and the npcs switch over to it
+	class NpcType {
+		public:
+			NpcType();
+			virtual ~NpcType();
+
+			bool loadFromXml(const std::string& filename);
+
+			typedef std::map<std::string, std::string> ParametersMap;
+			typedef std::list<Voice> VoiceList;
+			typedef std::map<std::string, std::list<ListItem> > ItemListMap;
+
+			std::string name, nameDescription, scriptFile;
+			uint32_t walkTicks;
+			int32_t talkRadius, idleTime, idleInterval, baseSpeed, health, healthMax;
+			bool floorChange, attackable, walkable, hasBusyReply, defaultPublic, hideName, hideHealth;
+
+			Skulls_t skull;
+			PartyShields_t shield;
+			GuildEmblems_t emblem;
+			Outfit_t outfit;
+
+			ParametersMap parameters;
+			VoiceList voiceList;
+			ItemListMap itemListMap;
+
+			ResponseList responseList;
+			ResponseMatcher responseMatcher;
+
+		protected:
+			uint32_t loadParams(xmlNodePtr node);
+			ResponseList loadInteraction(xmlNodePtr node);
+
+		private:
+			NpcType(const NpcType&);
+	};
+
 	class Npc : public Creature {
 		public:
 			#ifdef __ENABLE_SERVER_DIAGNOSTIC__
@@ -387,10 +471,10 @@
 				return false;
 			}
 			virtual bool isAttackable() const {
-				return attackable;
+				return npcType->attackable;
 			}
 			virtual bool isWalkable() const {
-				return walkable;
+				return npcType->walkable;
 			}
 
 			virtual bool canSee(const Position& pos) const;
@@ -444,17 +528,17 @@
 			bool getRandomStep(Direction& dir);
 
 			void reset();
-			bool loadFromXml(const std::string& name);
+			void applyType();
 			bool canWalkTo(const Position& fromPos, Direction dir);
 
-			const NpcResponse* getResponse(const ResponseList& list, const Player* player, NpcState* npcState, const std::string& text, bool exactMatch = false);
+			const NpcResponse* getResponse(const ResponseMatcher& matcher, const Player* player, NpcState* npcState, const std::string& text, bool exactMatch = false);
 			const NpcResponse* getResponse(const Player* player, NpcState* npcState, const std::string& text);
 			const NpcResponse* getResponse(const Player* player, NpcEvent_t eventType);
 			const NpcResponse* getResponse(const Player* player, NpcState* npcState, NpcEvent_t eventType);
 			std::string getEventResponseName(NpcEvent_t eventType);
 
 			NpcState* getState(const Player* player, bool makeNew = true);
-			uint32_t getMatchCount(NpcResponse* response, StringVec wordList, bool exactMatch, int32_t& matchAllCount, int32_t& totalKeywordCount);
+			uint32_t getMatchCount(NpcResponse* response, const StringVec& wordList, bool exactMatch, int32_t& matchAllCount, int32_t& totalKeywordCount);
 			uint32_t getListItemPrice(uint16_t itemId, ShopEvent_t type);
 
 			std::string formatResponse(Creature* creature, const NpcState* npcState, const NpcResponse* response) const;
@@ -463,20 +547,14 @@
 			void onPlayerEnter(Player* player, NpcState* state);
 			void onPlayerLeave(Player* player, NpcState* state);
 
-			typedef std::map<std::string, std::string> ParametersMap;
-			ParametersMap m_parameters;
-
-			uint32_t loadParams(xmlNodePtr node);
-			ResponseList loadInteraction(xmlNodePtr node);
-
 			void addShopPlayer(Player* player);
 			void removeShopPlayer(const Player* player);
 			void closeAllShopWindows();
 
-			uint32_t walkTicks;
+			NpcType_ptr npcType;
 			std::string name, nameDescription, m_filename;
-			int32_t talkRadius, idleTime, idleInterval, focusCreature;
-			bool floorChange, attackable, walkable, isIdle, hasBusyReply, hasScriptedFocus, defaultPublic;
+			int32_t focusCreature;
+			bool isIdle, hasScriptedFocus;
 			int64_t lastVoice;
 
 			typedef std::list<Player*> ShopPlayerList;
@@ -488,14 +566,7 @@
 			typedef std::list<uint32_t> QueueList;
 			QueueList queueList;
 
-			typedef std::list<Voice> VoiceList;
-			VoiceList voiceList;
-
-			typedef std::map<std::string, std::list<ListItem> > ItemListMap;
-			ItemListMap itemListMap;
-
 			ResponseScriptMap responseScriptMap;
-			ResponseList responseList;
 
 			NpcEvents* m_npcEventHandler;
 			static NpcScript* m_interface;
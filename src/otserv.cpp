@@ -189,17 +189,17 @@ bool argumentsHandler(StringVec args) {
 	void signalHandler(int32_t sig) {
 		switch (sig) {
 			case SIGHUP: {
-				Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::saveGameState, &g_game, false)));
+				Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::proceduralSave, &g_game, false)));
 				break;
 			}
 
 			case SIGTRAP: {
-				g_game.cleanMap();
+				Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::cleanMap, &g_game)));
 				break;
 			}
 
 			case SIGCHLD: {
-				g_game.proceduralRefresh();
+				Dispatcher::getInstance().addTask(createTask(boost::bind(&Game::proceduralRefresh, &g_game)));
 				break;
 			}
 
@@ -752,7 +752,10 @@ void otserv(StringVec, ServiceManager* services) {
 		services->add<ProtocolAdmin>(g_config.getNumber(ConfigManager::ADMIN_PORT), ipList);
 	#endif
 
-	// services->add<ProtocolHTTP>(8080, ipList);
+	if (g_config.getNumber(ConfigManager::HTTP_PORT)) {
+		services->add<ProtocolHTTP>(g_config.getNumber(ConfigManager::HTTP_PORT), ipList);
+	}
+
 	if (
 		#ifdef __LOGIN_SERVER__
 			true
@@ -35,6 +35,7 @@
 	#include <boost/thread.hpp>
 	#include <boost/foreach.hpp>
 	#include <boost/shared_ptr.hpp>
+	#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 	#include <cstddef>
 	#include <cstdlib>
@@ -117,6 +118,11 @@
 		return ((int64_t)t.millitm) + ((int64_t)t.time) * 1000;
 	}
 
+	inline int64_t OTSYS_TIME_MICRO() {
+		static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+		return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds();
+	}
+
 	inline uint32_t swap_uint32(uint32_t val) {
 		val = ((val << 8) & 0xFF00FF00) | ((val >> 8) & 0xFF00FF);
 		return (val << 16) | (val >> 16);
@@ -20,6 +20,7 @@
 
 #include "outputmessage.h"
 #include "protocol.h"
+#include "metrics.h"
 
 #ifdef __ENABLE_SERVER_DIAGNOSTIC__
 	uint32_t OutputMessagePool::outputMessagePoolCount = OUTPUT_POOL_SIZE;
@@ -34,6 +35,8 @@ OutputMessagePool::OutputMessagePool() {
 		m_allMessages.push_back(msg);
 #endif
 	}
+
+	Metrics::getInstance()->set(METRIC_OUTPUT_MESSAGES, OUTPUT_POOL_SIZE);
 	m_frameTime = OTSYS_TIME();
 }
 
@@ -100,6 +103,7 @@ void OutputMessagePool::sendAll() {
 	}
 
 	m_addQueue.clear();
+	uint32_t waiting = 0;
 	for (it = m_autoSend.begin(); it != m_autoSend.end();) {
 		OutputMessage_ptr omsg = (*it);
 
@@ -128,9 +132,12 @@ void OutputMessagePool::sendAll() {
 				#endif
 				it = m_autoSend.erase(it);
 			} else {
+				++waiting;
 				++it;
 			}
 	}
+
+	Metrics::getInstance()->set(METRIC_OUTPUT_MESSAGES_AUTOSEND, waiting);
 }
 
 void OutputMessagePool::releaseMessage(OutputMessage* msg) {
@@ -158,6 +165,7 @@ void OutputMessagePool::internalReleaseMessage(OutputMessage* msg) {
 
 	m_outputPoolLock.lock();
 	m_outputMessages.push_back(msg);
+	Metrics::getInstance()->add(METRIC_OUTPUT_MESSAGES_USED, -1);
 	m_outputPoolLock.unlock();
 }
 
@@ -182,6 +190,7 @@ OutputMessage_ptr OutputMessagePool::getOutputMessage(Protocol* protocol, bool a
 
 		OutputMessage* msg = new OutputMessage();
 		m_outputMessages.push_back(msg);
+		Metrics::getInstance()->add(METRIC_OUTPUT_MESSAGES);
 
 		#ifdef __TRACK_NETWORK__
 			m_allMessages.push_back(msg);
@@ -192,6 +201,8 @@ OutputMessage_ptr OutputMessagePool::getOutputMessage(Protocol* protocol, bool a
 	omsg.reset(m_outputMessages.back(), boost::bind(&OutputMessagePool::releaseMessage, this, _1));
 
 	m_outputMessages.pop_back();
+	Metrics::getInstance()->add(METRIC_OUTPUT_MESSAGES_USED);
+
 	configureOutputMessage(omsg, protocol, autoSend);
 	return omsg;
 }
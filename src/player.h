@@ -795,6 +795,12 @@
 				}
 			}
 
+			void sendCreatureSay(const NetworkFragment_ptr& fragment) {
+				if (client) {
+					client->sendCreatureSay(fragment);
+				}
+			}
+
 			void sendCreatureSquare(const Creature* creature, uint8_t color) {
 				if (client) {
 					client->sendCreatureSquare(creature, color);
@@ -936,6 +942,12 @@
 				}
 			}
 
+			void sendAnimatedText(const Position& pos, const NetworkFragment_ptr& fragment) const {
+				if (client) {
+					client->sendAnimatedText(pos, fragment);
+				}
+			}
+
 			void sendCancel(const std::string& msg) const {
 				if (client) {
 					client->sendCancel(msg);
@@ -968,12 +980,24 @@
 				}
 			}
 
+			void sendCreatureHealth(const Creature* creature, const NetworkFragment_ptr& fragment) const {
+				if (client) {
+					client->sendCreatureHealth(creature, fragment);
+				}
+			}
+
 			void sendDistanceShoot(const Position& from, const Position& to, uint8_t type) const {
 				if (client) {
 					client->sendDistanceShoot(from, to, type);
 				}
 			}
 
+			void sendDistanceShoot(const Position& from, const Position& to, uint8_t type, const NetworkFragment_ptr& fragment) const {
+				if (client) {
+					client->sendDistanceShoot(from, to, type, fragment);
+				}
+			}
+
 			void sendHouseWindow(House* house, uint32_t listId) const;
 
 			void sendOutfitWindow() const {
@@ -1026,6 +1050,12 @@
 				}
 			}
 
+			void sendMagicEffect(const Position& pos, uint8_t type, const NetworkFragment_ptr& fragment) const {
+				if (client) {
+					client->sendMagicEffect(pos, type, fragment);
+				}
+			}
+
 			void sendStats() const {
 				if (client) {
 					client->sendStats();
@@ -1420,5 +1450,6 @@
 			friend class Actions;
 			friend class IOLoginData;
 			friend class ProtocolGame;
+			friend class SaveJob;
 	};
 #endif
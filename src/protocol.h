@@ -33,8 +33,9 @@
 			Protocol(Connection_ptr connection) {
 				m_connection = connection;
 				m_refCount = 0;
+				m_metricsIndex = 0;
 
-				m_rawMessages = m_encryptionEnabled = m_checksumEnabled = false;
+				m_rawMessages = m_rawInput = m_encryptionEnabled = m_checksumEnabled = false;
 				for (int8_t i = 0; i < 4; ++i) {
 					m_key[i] = 0;
 				}
@@ -46,6 +47,8 @@
 
 			void onRecvMessage(NetworkMessage& msg);
 			void onSendMessage(OutputMessage_ptr msg);
+			// network thread, everything handed to the connection has been written
+			virtual void onSendComplete() {}
 
 			virtual void parsePacket(NetworkMessage&) {}
 			uint32_t getIP() const;
@@ -67,6 +70,13 @@
 				return --m_refCount;
 			}
 
+			void setMetricsIndex(uint8_t index) {
+				m_metricsIndex = index;
+			}
+			uint8_t getMetricsIndex() const {
+				return m_metricsIndex;
+			}
+
 		protected:
 			// use this function for autosend messages only
 			OutputMessage_ptr getOutputBuffer();
@@ -74,6 +84,10 @@
 			void setRawMessages(bool value) {
 				m_rawMessages = value;
 			}
+			// input has no length header, the connection passes whatever arrives
+			void setRawInput(bool value) {
+				m_rawInput = value;
+			}
 			void enableChecksum() {
 				m_checksumEnabled = true;
 			}
@@ -105,7 +119,8 @@
 			Connection_ptr m_connection;
 			uint32_t m_refCount;
 
-			bool m_rawMessages, m_encryptionEnabled, m_checksumEnabled;
+			bool m_rawMessages, m_rawInput, m_encryptionEnabled, m_checksumEnabled;
 			uint32_t m_key[4];
+			uint8_t m_metricsIndex;
 	};
 #endif
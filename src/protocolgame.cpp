@@ -593,24 +593,13 @@ void ProtocolGame::GetTileDescription(const Tile* tile, NetworkMessage_ptr msg)
 		return;
 	}
 
-	int32_t count = 0;
-	if (tile->ground) {
-		msg->putItem(tile->ground);
-		count++;
-	}
-
-	const TileItemVector* items = tile->getItemList();
-	const CreatureVector* creatures = tile->getCreatures();
-
-	ItemVector::const_iterator it;
-	if (items) {
-		for (it = items->getBeginTopItem(); (it != items->getEndTopItem() && count < 10); ++it, ++count) {
-			msg->putItem(*it);
-		}
-	}
+	// the items are encoded once per change of the tile, not once per player
+	const TileDescription& description = tile->getDescription();
+	msg->putBytes(description.getTop(), description.topSize);
 
-	if (creatures) {
-		for (CreatureVector::const_reverse_iterator cit = creatures->rbegin(); (cit != creatures->rend() && count < 10); ++cit) {
+	int32_t count = description.topCount;
+	if (const CreatureVector* creatures = tile->getCreatures()) {
+		for (CreatureVector::const_reverse_iterator cit = creatures->rbegin(); (cit != creatures->rend() && count < TILE_DESCRIPTION_ITEMS); ++cit) {
 			if (!player->canSeeCreature(*cit)) {
 				continue;
 			}
@@ -624,10 +613,9 @@ void ProtocolGame::GetTileDescription(const Tile* tile, NetworkMessage_ptr msg)
 		}
 	}
 
-	if (items) {
-		for (it = items->getBeginDownItem(); (it != items->getEndDownItem() && count < 10); ++it, ++count) {
-			msg->putItem(*it);
-		}
+	int32_t down = std::min((int32_t)description.downCount, TILE_DESCRIPTION_ITEMS - count);
+	if (down > 0) {
+		msg->putBytes(description.getDown(), description.downEnd[down - 1]);
 	}
 }
 
@@ -655,10 +643,37 @@ void ProtocolGame::GetMapDescription(int32_t x, int32_t y, int32_t z, int32_t wi
 }
 
 void ProtocolGame::GetFloorDescription(NetworkMessage_ptr msg, int32_t x, int32_t y, int32_t z, int32_t width, int32_t height, int32_t offset, int32_t& skip) {
+	// walk the leaves along each column instead of looking up every tile,
+	// a new leaf is only needed when crossing into the next FLOOR_SIZE block
+	QTreeLeafNode* columnLeaf = NULL;
+	QTreeLeafNode* leaf = NULL;
+
+	Floor* floor = NULL;
 	Tile* tile = NULL;
 	for (int32_t nx = 0; nx < width; nx++) {
+		uint16_t px = x + nx + offset, startY = y + offset;
+		if (!nx || !(px & FLOOR_MASK)) {
+			columnLeaf = (nx && columnLeaf ? columnLeaf->stepEast() : NULL);
+			if (!columnLeaf) {
+				columnLeaf = g_game.getLeaf(px, startY);
+			}
+		}
+
 		for (int32_t ny = 0; ny < height; ny++) {
-			if ((tile = g_game.getTile(Position(x + nx + offset, y + ny + offset, z)))) {
+			uint16_t py = startY + ny;
+			if (!ny) {
+				leaf = columnLeaf;
+				floor = (leaf ? leaf->getFloor(z) : NULL);
+			} else if (!(py & FLOOR_MASK)) {
+				leaf = (leaf ? leaf->stepSouth() : NULL);
+				if (!leaf) {
+					leaf = g_game.getLeaf(px, py);
+				}
+
+				floor = (leaf ? leaf->getFloor(z) : NULL);
+			}
+
+			if (floor && (tile = floor->tiles[px & FLOOR_MASK][py & FLOOR_MASK])) {
 				if (skip >= 0) {
 					msg->put<char>(skip);
 					msg->put<char>(0xFF);
@@ -679,16 +694,13 @@ void ProtocolGame::GetFloorDescription(NetworkMessage_ptr msg, int32_t x, int32_
 }
 
 void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& removedKnown) {
-	// loop through the known creature list and check if the given creature is in
-	for (std::list<uint32_t>::iterator it = knownCreatureList.begin(); it != knownCreatureList.end(); ++it) {
-		if ((*it) != id) {
-			continue;
-		}
-
+	KnownCreatureIndex::iterator it = knownCreatureIndex.find(id);
+	if (it != knownCreatureIndex.end()) {
 		// know... make the creature even more known...
-		knownCreatureList.erase(it);
-		knownCreatureList.push_back(id);
+		std::list<uint32_t>& list = it->second.offscreen ? offscreenCreatureList : knownCreatureList;
+		knownCreatureList.splice(knownCreatureList.end(), list, it->second.it);
 
+		it->second.offscreen = false;
 		known = true;
 		return;
 	}
@@ -696,28 +708,47 @@ void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& remo
 	// ok, he is unknown...
 	known = false;
 	// ... but not in future
-	knownCreatureList.push_back(id);
+	KnownCreature& entry = knownCreatureIndex[id];
+	entry.it = knownCreatureList.insert(knownCreatureList.end(), id);
+	entry.offscreen = false;
 	// too many known creatures?
-	if (knownCreatureList.size() > 250) {
-		// lets try to remove one from the end of the list
-		Creature* c = NULL;
-		for (int32_t n = 0; n < 250; n++) {
-			removedKnown = knownCreatureList.front();
-			if (!(c = g_game.getCreatureByID(removedKnown)) || !canSee(c)) {
-				break;
+	if (knownCreatureIndex.size() <= 250) {
+		// we can cache without problems :)
+		removedKnown = 0;
+		return;
+	}
+
+	if (offscreenCreatureList.empty()) {
+		// creatures that scrolled off the screen as the player walked are not
+		// reported, collect them all at once so the next evictions are free
+		for (std::list<uint32_t>::iterator lit = knownCreatureList.begin(); lit != knownCreatureList.end();) {
+			uint32_t knownId = *(lit++);
+			if (knownId == id) {
+				continue;
 			}
 
-			// this creature we can't remove, still in sight, so back to the end
-			knownCreatureList.pop_front();
-			knownCreatureList.push_back(removedKnown);
+			Creature* c = g_game.getCreatureByID(knownId);
+			if (!c || !canSee(c)) {
+				setCreatureOffscreen(knownId);
+			}
 		}
+	}
 
-		// hopefully we found someone to remove :S, we got only 250 tries
-		// if not... lets kick some players with debug errors :)
-		knownCreatureList.pop_front();
-	} else { // we can cache without problems :)
-		removedKnown = 0;
+	// everything is still in sight... lets kick some players with debug errors :)
+	std::list<uint32_t>& list = offscreenCreatureList.empty() ? knownCreatureList : offscreenCreatureList;
+	removedKnown = list.front();
+	knownCreatureIndex.erase(removedKnown);
+	list.pop_front();
+}
+
+void ProtocolGame::setCreatureOffscreen(uint32_t id) {
+	KnownCreatureIndex::iterator it = knownCreatureIndex.find(id);
+	if (it == knownCreatureIndex.end() || it->second.offscreen) {
+		return;
 	}
+
+	offscreenCreatureList.splice(offscreenCreatureList.end(), knownCreatureList, it->second.it);
+	it->second.offscreen = true;
 }
 
 bool ProtocolGame::canSee(const Creature* c) const {
@@ -1734,6 +1765,92 @@ void ProtocolGame::sendCreatureHealth(const Creature* creature) {
 	}
 }
 
+void ProtocolGame::sendDistanceShoot(const Position& from, const Position& to, uint8_t type, const NetworkFragment_ptr& fragment) {
+	if (type > SHOOT_EFFECT_LAST || (!canSee(from) && !canSee(to))) {
+		return;
+	}
+
+	appendFragment(fragment);
+}
+
+void ProtocolGame::sendMagicEffect(const Position& pos, uint8_t type, const NetworkFragment_ptr& fragment) {
+	if (type > MAGIC_EFFECT_LAST || !canSee(pos)) {
+		return;
+	}
+
+	appendFragment(fragment);
+}
+
+void ProtocolGame::sendAnimatedText(const Position& pos, const NetworkFragment_ptr& fragment) {
+	if (!canSee(pos)) {
+		return;
+	}
+
+	appendFragment(fragment);
+}
+
+void ProtocolGame::sendCreatureHealth(const Creature* creature, const NetworkFragment_ptr& fragment) {
+	if (!canSee(creature)) {
+		return;
+	}
+
+	appendFragment(fragment);
+}
+
+void ProtocolGame::sendCreatureSay(const NetworkFragment_ptr& fragment) {
+	appendFragment(fragment);
+}
+
+NetworkFragment_ptr ProtocolGame::encodeDistanceShoot(const Position& from, const Position& to, uint8_t type) {
+	NetworkMessage_ptr buffer = getFragmentBuffer();
+	AddDistanceShoot(buffer, from, to, type);
+	return makeFragment(buffer);
+}
+
+NetworkFragment_ptr ProtocolGame::encodeMagicEffect(const Position& pos, uint8_t type) {
+	NetworkMessage_ptr buffer = getFragmentBuffer();
+	AddMagicEffect(buffer, pos, type);
+	return makeFragment(buffer);
+}
+
+NetworkFragment_ptr ProtocolGame::encodeAnimatedText(const Position& pos, uint8_t color, const std::string& text) {
+	NetworkMessage_ptr buffer = getFragmentBuffer();
+	AddAnimatedText(buffer, pos, color, text);
+	return makeFragment(buffer);
+}
+
+NetworkFragment_ptr ProtocolGame::encodeCreatureHealth(const Creature* creature) {
+	NetworkMessage_ptr buffer = getFragmentBuffer();
+	AddCreatureHealth(buffer, creature);
+	return makeFragment(buffer);
+}
+
+NetworkFragment_ptr ProtocolGame::encodeCreatureSay(const Creature* creature, SpeakClasses type, const std::string& text, Position* pos) {
+	// one statement id per event, every listener reports the same line
+	NetworkMessage_ptr buffer = getFragmentBuffer();
+	AddCreatureSpeak(buffer, creature, type, text, 0, 0, pos);
+	return makeFragment(buffer);
+}
+
+NetworkMessage_ptr ProtocolGame::getFragmentBuffer() {
+	// dispatcher thread only, so one scratch message is enough
+	static NetworkMessage_ptr buffer(new NetworkMessage);
+	buffer->reset(0);
+	return buffer;
+}
+
+NetworkFragment_ptr ProtocolGame::makeFragment(NetworkMessage_ptr buffer) {
+	return NetworkFragment_ptr(new std::string(buffer->buffer(), buffer->size()));
+}
+
+void ProtocolGame::appendFragment(const NetworkFragment_ptr& fragment) {
+	NetworkMessage_ptr msg = getOutputBuffer();
+	if (msg) {
+		TRACK_MESSAGE(msg);
+		msg->putBytes(fragment->data(), fragment->size());
+	}
+}
+
 void ProtocolGame::sendFYIBox(const std::string& message) {
 	if (message.empty() || message.length() > 1018) { // Prevent client debug when message is empty or length is > 1018 (not confirmed)
 		std::clog << "[Warning - ProtocolGame::sendFYIBox] Trying to send an empty or too huge message." << std::endl;
@@ -1867,11 +1984,12 @@ void ProtocolGame::sendAddCreature(const Creature* creature, const Position& pos
 	}
 }
 
-void ProtocolGame::sendRemoveCreature(const Creature*, const Position& pos, uint32_t stackpos) {
+void ProtocolGame::sendRemoveCreature(const Creature* creature, const Position& pos, uint32_t stackpos) {
 	if (!canSee(pos)) {
 		return;
 	}
 
+	setCreatureOffscreen(creature->getID());
 	NetworkMessage_ptr msg = getOutputBuffer();
 	if (msg) {
 		TRACK_MESSAGE(msg);
@@ -1943,6 +2061,7 @@ void ProtocolGame::sendMoveCreature(const Creature* creature, const Tile*, const
 			return;
 		}
 
+		setCreatureOffscreen(creature->getID());
 		NetworkMessage_ptr msg = getOutputBuffer();
 		if (msg) {
 			TRACK_MESSAGE(msg);
@@ -2184,8 +2303,7 @@ void ProtocolGame::reloadCreature(const Creature* creature) {
 	NetworkMessage_ptr msg = getOutputBuffer();
 	if (msg) {
 		TRACK_MESSAGE(msg);
-		std::list<uint32_t>::iterator it = std::find(knownCreatureList.begin(), knownCreatureList.end(), creature->getID());
-		if (it != knownCreatureList.end()) {
+		if (knownCreatureIndex.find(creature->getID()) != knownCreatureIndex.end()) {
 			RemoveTileItem(msg, creature->getPosition(), stackpos);
 			msg->put<char>(0x6A);
 
@@ -18,6 +18,8 @@
 #ifndef __PROTOCOLGAME__
 	#define __PROTOCOLGAME__
 
+	#include <boost/tr1/unordered_map.hpp>
+
 	#include "otsystem.h"
 	#include "enums.h"
 
@@ -71,11 +73,33 @@
 
 			void setPlayer(Player* p);
 
+			// viewer independent packets, encoded once per event and appended as is
+			// to the batch of every spectator that passes the visibility check
+			static NetworkFragment_ptr encodeDistanceShoot(const Position& from, const Position& to, uint8_t type);
+			static NetworkFragment_ptr encodeMagicEffect(const Position& pos, uint8_t type);
+			static NetworkFragment_ptr encodeAnimatedText(const Position& pos, uint8_t color, const std::string& text);
+			static NetworkFragment_ptr encodeCreatureHealth(const Creature* creature);
+			static NetworkFragment_ptr encodeCreatureSay(const Creature* creature, SpeakClasses type, const std::string& text, Position* pos = NULL);
+
 		private:
 			void disconnectClient(uint8_t error, const char* message);
 
-			std::list<uint32_t> knownCreatureList;
+			// creatures the client shows and those it dropped from its screen, each list
+			// least recently described first, so eviction takes the off-screen front
+			struct KnownCreature {
+				std::list<uint32_t>::iterator it;
+				bool offscreen;
+			};
+
+			typedef std::tr1::unordered_map<uint32_t, KnownCreature> KnownCreatureIndex;
+			std::list<uint32_t> knownCreatureList, offscreenCreatureList;
+			KnownCreatureIndex knownCreatureIndex;
 			void checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& removedKnown);
+			void setCreatureOffscreen(uint32_t id);
+
+			static NetworkMessage_ptr getFragmentBuffer();
+			static NetworkFragment_ptr makeFragment(NetworkMessage_ptr buffer);
+			void appendFragment(const NetworkFragment_ptr& fragment);
 
 			bool connect(uint32_t playerId, OperatingSystem_t operatingSystem, uint16_t version);
 			void disconnect();
@@ -187,6 +211,12 @@
 			void sendMagicEffect(const Position& pos, uint8_t type);
 			void sendAnimatedText(const Position& pos, uint8_t color, std::string text);
 			void sendCreatureHealth(const Creature* creature);
+
+			void sendDistanceShoot(const Position& from, const Position& to, uint8_t type, const NetworkFragment_ptr& fragment);
+			void sendMagicEffect(const Position& pos, uint8_t type, const NetworkFragment_ptr& fragment);
+			void sendAnimatedText(const Position& pos, const NetworkFragment_ptr& fragment);
+			void sendCreatureHealth(const Creature* creature, const NetworkFragment_ptr& fragment);
+			void sendCreatureSay(const NetworkFragment_ptr& fragment);
 			void sendSkills();
 			void sendPing();
 			void sendCreatureTurn(const Creature* creature, int16_t stackpos);
@@ -271,13 +301,13 @@
 
 			void AddMapDescription(NetworkMessage_ptr msg, const Position& pos);
 			void AddTextMessage(NetworkMessage_ptr msg, MessageClasses mclass, const std::string& message);
-			void AddAnimatedText(NetworkMessage_ptr msg, const Position& pos, uint8_t color, const std::string& text);
-			void AddMagicEffect(NetworkMessage_ptr msg, const Position& pos, uint8_t type);
-			void AddDistanceShoot(NetworkMessage_ptr msg, const Position& from, const Position& to, uint8_t type);
+			static void AddAnimatedText(NetworkMessage_ptr msg, const Position& pos, uint8_t color, const std::string& text);
+			static void AddMagicEffect(NetworkMessage_ptr msg, const Position& pos, uint8_t type);
+			static void AddDistanceShoot(NetworkMessage_ptr msg, const Position& from, const Position& to, uint8_t type);
 			void AddCreature(NetworkMessage_ptr msg, const Creature* creature, bool known, uint32_t remove);
 			void AddPlayerStats(NetworkMessage_ptr msg);
-			void AddCreatureSpeak(NetworkMessage_ptr msg, const Creature* creature, SpeakClasses type, std::string text, uint16_t channelId, uint32_t time = 0, Position* pos = NULL);
-			void AddCreatureHealth(NetworkMessage_ptr msg, const Creature* creature);
+			static void AddCreatureSpeak(NetworkMessage_ptr msg, const Creature* creature, SpeakClasses type, std::string text, uint16_t channelId, uint32_t time = 0, Position* pos = NULL);
+			static void AddCreatureHealth(NetworkMessage_ptr msg, const Creature* creature);
 			void AddCreatureOutfit(NetworkMessage_ptr msg, const Creature* creature, const Outfit_t& outfit, bool outfitWindow = false);
 			void AddPlayerSkills(NetworkMessage_ptr msg);
 			void AddWorldLight(NetworkMessage_ptr msg, const LightInfo& lightInfo);
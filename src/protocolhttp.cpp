@@ -20,6 +20,7 @@
 
 #include "outputmessage.h"
 #include "connection.h"
+#include "metrics.h"
 
 #ifdef __ENABLE_SERVER_DIAGNOSTIC__
 	uint32_t ProtocolHTTP::protocolHTTPCount = 0;
@@ -37,28 +38,95 @@ void ProtocolHTTP::disconnectClient() {
 	getConnection()->close();
 }
 
-bool ProtocolHTTP::parseFirstPacket(NetworkMessage&) {
-	if (OutputMessage_ptr output = OutputMessagePool::getInstance()->getOutputMessage(this, false)) {
-		TRACK_MESSAGE(output);
-
-		output->putString("HTTP/1.1 200 OK");
-		output->putString("Date: Fri, 27 Mar 2009 17:28.13 GMT\r\n");
-		output->putString("Server: The Forgotten Server httpd/0.4\r\n");
-		output->putString("Content-Location: filename.html\r\n");
-		// Vary: negotiate\r\n
-		// TCN: choice\r\n
-		output->putString("Last-Modified: Fri, 27 Mar 2009 17:28.13 GMT\r\n");
-		output->putString("Accept-Ranges: bytes\r\n");
-		output->putString("Content-Length: 1234\r\n");
-		output->putString("Expires: Fri, 27 Mar 2009 17:28.13 GMT\r\n");
-		output->putString("Connection: close\r\n");
-		output->putString("Content-Type: text/html qs = 0.7\r\n");
-		output->putString("\r\n");
-		output->putString("<html><head><title>The Forgotten Server httpd</title></head><body>It works (apache ripoff ;D)!</body></html>");
-
-		OutputMessagePool::getInstance()->send(output);
+void ProtocolHTTP::parsePacket(NetworkMessage& msg) {
+	// network thread, requests are answered without touching the dispatcher
+	if (!m_response.empty()) {
+		// one request per connection, anything sent while answering is ignored
+		return;
 	}
 
-	getConnection()->close();
-	return true;
+	m_request += msg.getRaw();
+	std::string::size_type end = m_request.find("\r\n\r\n");
+	if (end == std::string::npos) {
+		if (m_request.size() > HTTP_MAX_REQUEST_SIZE) {
+			sendResponse("413 Request Entity Too Large", "text/plain", "Request too large\n");
+		}
+		return;
+	}
+
+	std::string::size_type methodEnd = m_request.find(' '), targetEnd = std::string::npos;
+	if (methodEnd != std::string::npos) {
+		targetEnd = m_request.find(' ', methodEnd + 1);
+	}
+
+	if (targetEnd == std::string::npos || targetEnd > end) {
+		sendResponse("400 Bad Request", "text/plain", "Bad request\n");
+		return;
+	}
+
+	std::string method = m_request.substr(0, methodEnd), target = m_request.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+	std::string::size_type query = target.find('?');
+	if (query != std::string::npos) {
+		target.erase(query);
+	}
+
+	if (method != "GET" && method != "HEAD") {
+		sendResponse("405 Method Not Allowed", "text/plain", "Method not allowed\n");
+	} else if (target == "/metrics") {
+		sendResponse("200 OK", "text/plain; version=0.0.4", Metrics::getInstance()->getPrometheusText(), method == "GET");
+	} else {
+		sendResponse("404 Not Found", "text/plain", "Not found\n", method == "GET");
+	}
+}
+
+void ProtocolHTTP::sendResponse(const std::string& status, const std::string& contentType, const std::string& body, bool sendBody/* = true*/) {
+	char date[50];
+	time_t now = time(NULL);
+	strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", gmtime(&now));
+
+	std::stringstream s;
+	s << "HTTP/1.1 " << status << "\r\n";
+	s << "Date: " << date << "\r\n";
+	s << "Server: " << SOFTWARE_NAME << "/" << SOFTWARE_VERSION << "\r\n";
+	s << "Content-Type: " << contentType << "\r\n";
+	s << "Content-Length: " << body.size() << "\r\n";
+	s << "Connection: close\r\n";
+	s << "\r\n";
+	if (sendBody) {
+		s << body;
+	}
+
+	m_request.clear();
+	m_response = s.str();
+	m_responseOffset = 0;
+	sendChunk();
+}
+
+void ProtocolHTTP::sendChunk() {
+	// chunks go out one at a time, the next one once the previous has been written
+	OutputMessage_ptr output = OutputMessagePool::getInstance()->getOutputMessage(this, false);
+	if (!output) {
+		disconnectClient();
+		return;
+	}
+
+	TRACK_MESSAGE(output);
+	size_t size = std::min((size_t)(NETWORK_MAX_SIZE - 32), m_response.size() - m_responseOffset);
+	output->putBytes(m_response.c_str() + m_responseOffset, size);
+	m_responseOffset += size;
+	OutputMessagePool::getInstance()->send(output);
+}
+
+void ProtocolHTTP::onSendComplete() {
+	if (m_response.empty()) {
+		return;
+	}
+
+	if (m_responseOffset < m_response.size()) {
+		sendChunk();
+		return;
+	}
+
+	// Connection: close, hang up once the last chunk is out
+	disconnectClient();
 }
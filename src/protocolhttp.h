@@ -19,6 +19,8 @@
 	#define __PROTOCOL_HTTP__
 	#include "protocol.h"
 
+	#define HTTP_MAX_REQUEST_SIZE 8192
+
 	class NetworkMessage;
 	class ProtocolHTTP : public Protocol {
 		public:
@@ -27,16 +29,19 @@
 			#endif
 
 			virtual void onRecvFirstMessage(NetworkMessage& msg) {
-				parseFirstPacket(msg);
+				parsePacket(msg);
 			}
+			virtual void parsePacket(NetworkMessage& msg);
+			virtual void onSendComplete();
 
 			ProtocolHTTP(Connection_ptr connection):
-				Protocol(connection) {
+				Protocol(connection), m_responseOffset(0) {
 					#ifdef __ENABLE_SERVER_DIAGNOSTIC__
 						protocolHTTPCount++;
 					#endif
 
 					setRawMessages(true);
+					setRawInput(true);
 				}
 			virtual ~ProtocolHTTP() {
 				#ifdef __ENABLE_SERVER_DIAGNOSTIC__
@@ -55,6 +60,10 @@
 			virtual void deleteProtocolTask();
 
 			void disconnectClient();
-			bool parseFirstPacket(NetworkMessage& msg);
+			void sendResponse(const std::string& status, const std::string& contentType, const std::string& body, bool sendBody = true);
+			void sendChunk();
+
+			std::string m_request, m_response;
+			size_t m_responseOffset;
 	};
 #endif
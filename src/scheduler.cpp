@@ -22,10 +22,15 @@
 	#include "exception.h"
 #endif
 
+#ifdef __OTSERV_ALLOCATOR__
+	DEFINE_SLAB_ALLOCATOR(SchedulerTask, "scheduler_task", sizeof(SchedulerTask))
+#endif
+
 Scheduler::SchedulerState Scheduler::m_threadState = Scheduler::STATE_TERMINATED;
 
 Scheduler::Scheduler() {
 	m_lastEvent = 0;
+	m_eventCount = 0;
 	Scheduler::m_threadState = STATE_RUNNING;
 	boost::thread(boost::bind(&Scheduler::schedulerThread, (void*)this));
 }
@@ -59,6 +64,7 @@ void Scheduler::schedulerThread(void* p) {
 			// ok we had a timeout, so there has to be an event we have to execute...
 			task = scheduler->m_eventList.top();
 			scheduler->m_eventList.pop();
+			scheduler->m_eventCount.store(scheduler->m_eventList.size(), boost::memory_order_relaxed);
 
 			// check if the event was stopped
 			EventIds::iterator it = scheduler->m_eventIds.find(task->getEventId());
@@ -74,6 +80,7 @@ void Scheduler::schedulerThread(void* p) {
 		if (task) {
 			// if it was not stopped
 			if (run) {
+				scheduler->m_lateness.add(std::max((int64_t)0, (int64_t)(boost::get_system_time() - task->getCycle()).total_microseconds()));
 				task->unsetExpiration();
 				Dispatcher::getInstance().addTask(task);
 			} else {
@@ -106,6 +113,7 @@ uint32_t Scheduler::addEvent(SchedulerTask* task) {
 		m_eventIds.insert(task->getEventId());
 		// add the event to the queue
 		m_eventList.push(task);
+		m_eventCount.store(m_eventList.size(), boost::memory_order_relaxed);
 
 		// if the list was empty or this event is the top in the list
 		// we have to signal it
@@ -159,6 +167,7 @@ void Scheduler::shutdown() {
 		m_eventList.pop();
 	}
 
+	m_eventCount = 0;
 	m_eventIds.clear();
 	m_eventLock.unlock();
 }
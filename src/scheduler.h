@@ -21,10 +21,19 @@
 	#include "otsystem.h"
 
 	#include "dispatcher.h"
+
+	#ifdef __OTSERV_ALLOCATOR__
+		#include "allocator.h"
+	#endif
+
 	#define SCHEDULER_MINTICKS 50
 
 	class SchedulerTask : public Task {
 		public:
+			#ifdef __OTSERV_ALLOCATOR__
+				DECLARE_SLAB_ALLOCATOR()
+			#endif
+
 			virtual ~SchedulerTask() {}
 
 			void setEventId(uint32_t eventId) {
@@ -80,6 +89,13 @@
 
 			static void schedulerThread(void* p);
 
+			uint32_t getEventCount() const {
+				return m_eventCount.load(boost::memory_order_relaxed);
+			}
+			const Histogram& getLateness() const {
+				return m_lateness;
+			}
+
 		protected:
 			Scheduler();
 			enum SchedulerState {
@@ -96,5 +112,8 @@
 
 			std::priority_queue<SchedulerTask*, std::vector<SchedulerTask*>, lessTask > m_eventList;
 			static SchedulerState m_threadState;
+
+			boost::atomic<uint32_t> m_eventCount;
+			Histogram m_lateness;
 	};
 #endif
@@ -19,6 +19,8 @@
 	#define __SERVER__
 
 	#include "otsystem.h"
+	#include "metrics.h"
+	#include "protocol.h"
 	#include <boost/enable_shared_from_this.hpp>
 
 	class ServiceBase;
@@ -30,7 +32,6 @@
 	class Connection;
 	typedef boost::shared_ptr<Connection> Connection_ptr;
 
-	class Protocol;
 	class NetworkMessage;
 
 	typedef boost::asio::ip::address IPAddress;
@@ -50,8 +51,14 @@
 	template <typename ProtocolType>
 	class Service : public ServiceBase {
 		public:
+			Service() {
+				m_metricsIndex = Metrics::getInstance()->registerProtocol(ProtocolType::protocolName());
+			}
+
 			Protocol* makeProtocol(Connection_ptr connection) const {
-				return new ProtocolType(connection);
+				Protocol* protocol = new ProtocolType(connection);
+				protocol->setMetricsIndex(m_metricsIndex);
+				return protocol;
 			}
 
 			uint8_t getProtocolId() const {
@@ -66,6 +73,9 @@
 			const char* getProtocolName() const {
 				return ProtocolType::protocolName();
 			}
+
+		protected:
+			uint8_t m_metricsIndex;
 	};
 
 	typedef boost::shared_ptr<boost::asio::ip::tcp::acceptor> Acceptor_ptr;
@@ -27,6 +27,7 @@
 
 #include "configmanager.h"
 #include "game.h"
+#include "metrics.h"
 
 extern ConfigManager g_config;
 extern Monsters g_monsters;
@@ -37,6 +38,7 @@ extern Game g_game;
 
 Spawns::Spawns() {
 	loaded = started = false;
+	hibernateEvent = hibernatingSpawns = 0;
 }
 
 Spawns::~Spawns() {
@@ -114,14 +116,20 @@ bool Spawns::parseSpawnNode(xmlNodePtr p, bool checkDuplicate) {
 	int32_t radius = intValue;
 	Spawn* spawn = new Spawn(centerPos, radius);
 	if (checkDuplicate) {
-		for (SpawnList::iterator it = spawnList.begin(); it != spawnList.end(); ++it) {
-			if ((*it)->getPosition() == centerPos) {
-				delete *it;
+		for (SpawnList::iterator it = spawnList.begin(); it != spawnList.end();) {
+			if ((*it)->getPosition() != centerPos) {
+				++it;
+				continue;
 			}
+
+			removeRegions(*it);
+			delete *it;
+			it = spawnList.erase(it);
 		}
 	}
 
 	spawnList.push_back(spawn);
+	addRegions(spawn);
 	for (xmlNodePtr tmpNode = p->children; tmpNode; tmpNode = tmpNode->next) {
 		if (!xmlStrcmp(tmpNode->name, (const xmlChar*)"monster")) {
 			if (!readXMLString(tmpNode, "name", strValue)) {
@@ -208,20 +216,109 @@ void Spawns::startup() {
 	for (SpawnList::iterator it = spawnList.begin(); it != spawnList.end(); ++it) {
 		(*it)->startup();
 	}
+
 	started = true;
+	if (g_config.getNumber(ConfigManager::SPAWN_HIBERNATION_RANGE) > 0) {
+		hibernateEvent = Scheduler::getInstance().addEvent(createSchedulerTask(SPAWN_HIBERNATE_INTERVAL, boost::bind(&Spawns::checkHibernation, this)));
+	}
 }
 
 void Spawns::clear() {
 	started = false;
+	if (hibernateEvent) {
+		Scheduler::getInstance().stopEvent(hibernateEvent);
+		hibernateEvent = 0;
+	}
+
 	for (SpawnList::iterator it = spawnList.begin(); it != spawnList.end(); ++it) {
 		delete (*it);
 	}
 
 	spawnList.clear();
+	regions.clear();
+	hibernatingSpawns = 0;
+
 	loaded = false;
 	filename = std::string();
 }
 
+void Spawns::addRegions(Spawn* spawn) {
+	if (spawn->getRadius() < 0) {
+		return;
+	}
+
+	const Position& pos = spawn->getPosition();
+	int32_t range = spawn->getRadius() + SPAWN_WAKE_RANGE,
+		x1 = std::max(0, pos.x - range) / SPAWN_REGION_SIZE, x2 = (pos.x + range) / SPAWN_REGION_SIZE,
+		y1 = std::max(0, pos.y - range) / SPAWN_REGION_SIZE, y2 = (pos.y + range) / SPAWN_REGION_SIZE;
+	for (int32_t y = y1; y <= y2; ++y) {
+		for (int32_t x = x1; x <= x2; ++x) {
+			regions[getRegionKey(x, y)].push_back(spawn);
+		}
+	}
+}
+
+void Spawns::removeRegions(Spawn* spawn) {
+	if (spawn->isHibernating()) {
+		--hibernatingSpawns;
+	}
+
+	for (SpawnRegionMap::iterator it = regions.begin(); it != regions.end();) {
+		it->second.remove(spawn);
+		if (it->second.empty()) {
+			regions.erase(it++);
+		} else {
+			++it;
+		}
+	}
+}
+
+void Spawns::checkHibernation() {
+	int32_t range = std::max((int32_t)g_config.getNumber(ConfigManager::SPAWN_HIBERNATION_RANGE), (int32_t)(SPAWN_WAKE_RANGE + FLOOR_SIZE));
+	hibernateEvent = Scheduler::getInstance().addEvent(createSchedulerTask(SPAWN_HIBERNATE_INTERVAL, boost::bind(&Spawns::checkHibernation, this)));
+
+	uint32_t hibernatingMonsters = 0;
+	const Map* map = g_game.getMap();
+	for (SpawnList::iterator it = spawnList.begin(); it != spawnList.end(); ++it) {
+		Spawn* spawn = (*it);
+		if (spawn->getRadius() < 0) {
+			continue;
+		}
+
+		if (!spawn->isHibernating() && spawn->isIdle() && !map->hasPlayerInRange(spawn->getPosition(), spawn->getRadius() + range, spawn->getRadius() + range)) {
+			spawn->hibernate();
+			++hibernatingSpawns;
+		}
+
+		if (spawn->isHibernating()) {
+			hibernatingMonsters += spawn->getSpawnedCount();
+		}
+	}
+
+	Metrics* metrics = Metrics::getInstance();
+	metrics->set(METRIC_SPAWNS_HIBERNATING, hibernatingSpawns);
+	metrics->set(METRIC_MONSTERS_HIBERNATING, hibernatingMonsters);
+}
+
+void Spawns::onPlayerEnter(const Position& pos) {
+	if (!hibernatingSpawns) {
+		return;
+	}
+
+	SpawnRegionMap::iterator it = regions.find(getRegionKey(pos.x / SPAWN_REGION_SIZE, pos.y / SPAWN_REGION_SIZE));
+	if (it == regions.end()) {
+		return;
+	}
+
+	for (SpawnList::iterator sit = it->second.begin(); sit != it->second.end(); ++sit) {
+		Spawn* spawn = (*sit);
+		if (spawn->isHibernating() && isInZone(spawn->getPosition(), spawn->getRadius() + SPAWN_WAKE_RANGE, pos)) {
+			spawn->wakeUp();
+			--hibernatingSpawns;
+		}
+	}
+}
+
 bool Spawns::isInZone(const Position& centerPos, int32_t radius, const Position& pos) {
 	if (radius == -1) {
 		return true;
@@ -230,7 +327,7 @@ bool Spawns::isInZone(const Position& centerPos, int32_t radius, const Position&
 }
 
 void Spawn::startEvent() {
-	if (!checkSpawnEvent) {
+	if (!checkSpawnEvent && !hibernating) {
 		checkSpawnEvent = Scheduler::getInstance().addEvent(createSchedulerTask(getInterval(), boost::bind(&Spawn::checkSpawn, this)));
 	}
 }
@@ -240,6 +337,7 @@ Spawn::Spawn(const Position& _pos, int32_t _radius) {
 	radius = _radius;
 	interval = DEFAULTSPAWN_INTERVAL;
 	checkSpawnEvent = 0;
+	hibernating = false;
 }
 
 Spawn::~Spawn() {
@@ -409,6 +507,39 @@ void Spawn::removeMonster(Monster* monster) {
 	}
 }
 
+void Spawn::hibernate() {
+	// only idle spawns hibernate, and idle monsters are not checked anyway
+	hibernating = true;
+	stopEvent();
+}
+
+void Spawn::wakeUp() {
+	hibernating = false;
+	// the player is still at least SPAWN_WAKE_RANGE away, respawn now before
+	// they come into view and block it, the check reschedules itself
+	stopEvent();
+	checkSpawn();
+}
+
+uint32_t Spawn::getSpawnedCount() const {
+	uint32_t count = 0;
+	for (SpawnedMap::const_iterator it = spawnedMap.begin(); it != spawnedMap.end(); ++it) {
+		if (!it->second->isRemoved()) {
+			++count;
+		}
+	}
+	return count;
+}
+
+bool Spawn::isIdle() const {
+	for (SpawnedMap::const_iterator it = spawnedMap.begin(); it != spawnedMap.end(); ++it) {
+		if (!it->second->isRemoved() && !it->second->getIdleStatus()) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void Spawn::stopEvent() {
 	if (!checkSpawnEvent) {
 		return;
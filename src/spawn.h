@@ -18,6 +18,8 @@
 #ifndef __SPAWN__
 	#define __SPAWN__
 
+	#include <boost/tr1/unordered_map.hpp>
+
 	#include "otsystem.h"
 
 	#include "templates.h"
@@ -29,6 +31,13 @@
 	class Spawn;
 	typedef std::list<Spawn*> SpawnList;
 
+	// spawns are bucketed by map regions of this size for waking up
+	#define SPAWN_REGION_SIZE 32
+	// a player this close to a spawn area wakes it, far enough to be noticed
+	// before the spawn gets into view even though players are tracked per leaf
+	#define SPAWN_WAKE_RANGE (Map::maxViewportX + FLOOR_SIZE)
+	#define SPAWN_HIBERNATE_INTERVAL 30000
+
 	class Spawns {
 		public:
 			virtual ~Spawns();
@@ -45,6 +54,9 @@
 			void startup();
 			void clear();
 
+			void checkHibernation();
+			void onPlayerEnter(const Position& pos);
+
 			bool isLoaded() const {
 				return loaded;
 			}
@@ -56,6 +68,17 @@
 			Spawns();
 			SpawnList spawnList;
 
+			typedef std::tr1::unordered_map<uint32_t, SpawnList> SpawnRegionMap;
+			SpawnRegionMap regions;
+			uint32_t hibernateEvent, hibernatingSpawns;
+
+			static uint32_t getRegionKey(int32_t regionX, int32_t regionY) {
+				return ((uint32_t)regionX << 16) | (uint32_t)regionY;
+			}
+
+			void addRegions(Spawn* spawn);
+			void removeRegions(Spawn* spawn);
+
 			typedef std::list<Npc*> NpcList;
 			NpcList npcList;
 
@@ -95,8 +118,23 @@
 				return Spawns::getInstance()->isInZone(centerPos, radius, pos);
 			}
 
+			int32_t getRadius() const {
+				return radius;
+			}
+
+			bool isHibernating() const {
+				return hibernating;
+			}
+			void hibernate();
+			void wakeUp();
+
+			uint32_t getSpawnedCount() const;
+			// false while any monster of the spawn is fighting or following, wherever it is
+			bool isIdle() const;
+
 		private:
 			uint32_t interval, checkSpawnEvent;
+			bool hibernating;
 
 			Position centerPos;
 			int32_t radius, despawnRange, despawnRadius;
@@ -39,6 +39,7 @@ extern ConfigManager g_config;
 Spells::Spells():
 	m_interface("Spell Interface") {
 		m_interface.initState();
+		instantsChanged = true;
 	}
 
 ReturnValue Spells::onPlayerSay(Player* player, const std::string& words) {
@@ -118,6 +119,7 @@ void Spells::clear() {
 	}
 
 	instants.clear();
+	instantsChanged = true;
 	m_interface.reInitState();
 }
 
@@ -139,6 +141,7 @@ Event* Spells::getEvent(const std::string& nodeName) {
 
 bool Spells::registerEvent(Event* event, xmlNodePtr, bool override) {
 	if (InstantSpell* instant = dynamic_cast<InstantSpell*>(event)) {
+		instantsChanged = true;
 		InstantsMap::iterator it = instants.find(instant->getWords());
 		if (it == instants.end()) {
 			instants[instant->getWords()] = instant;
@@ -200,16 +203,13 @@ RuneSpell* Spells::getRuneSpellByName(const std::string& name) {
 }
 
 InstantSpell* Spells::getInstantSpell(const std::string& words) {
-	InstantSpell* result = NULL;
-	for (InstantsMap::iterator it = instants.begin(); it != instants.end(); ++it) {
-		InstantSpell* instantSpell = it->second;
-		if (strncasecmp(instantSpell->getWords().c_str(), words.c_str(), instantSpell->getWords().length()) == 0) {
-			if (!result || instantSpell->getWords().length() > result->getWords().length()) {
-				result = instantSpell;
-			}
-		}
+	if (instantsChanged) {
+		instantsTrie.build(instants);
+		instantsChanged = false;
 	}
 
+	InstantSpell* result = instantsTrie.getLongestPrefix(words);
+
 	if (result && words.length() > result->getWords().length()) {
 		std::string param = words.substr(result->getWords().length(), words.length());
 		if (param[0] != ' ' || (param.length() > 1 && (!result->getHasParam() || param.find(' ', 1) != std::string::npos) && param[1] != '"')) {
@@ -219,6 +219,62 @@ InstantSpell* Spells::getInstantSpell(const std::string& words) {
 	return result;
 }
 
+void InstantsTrie::build(const InstantsMap& instants) {
+	m_nodes.clear();
+	m_nodes.push_back(Node());
+	for (InstantsMap::const_iterator it = instants.begin(); it != instants.end(); ++it) {
+		const std::string& words = it->second->getWords();
+		uint32_t node = 0;
+		for (std::string::const_iterator cit = words.begin(); cit != words.end(); ++cit) {
+			char c = tolower((uint8_t)*cit);
+			int32_t child = getChild(node, c);
+			if (child == -1) {
+				child = m_nodes.size();
+				std::vector<std::pair<char, uint32_t> >& children = m_nodes[node].children;
+				children.insert(std::lower_bound(children.begin(), children.end(), std::make_pair(c, (uint32_t)0)), std::make_pair(c, (uint32_t)child));
+				m_nodes.push_back(Node());
+			}
+
+			node = child;
+		}
+
+		// words differing only in case share a node, the first one in map order wins
+		if (!m_nodes[node].spell) {
+			m_nodes[node].spell = it->second;
+		}
+	}
+}
+
+InstantSpell* InstantsTrie::getLongestPrefix(const std::string& words) const {
+	if (m_nodes.empty()) {
+		return NULL;
+	}
+
+	InstantSpell* result = m_nodes[0].spell;
+	uint32_t node = 0;
+	for (std::string::const_iterator it = words.begin(); it != words.end(); ++it) {
+		int32_t child = getChild(node, tolower((uint8_t)*it));
+		if (child == -1) {
+			break;
+		}
+
+		node = child;
+		if (m_nodes[node].spell) {
+			result = m_nodes[node].spell;
+		}
+	}
+	return result;
+}
+
+int32_t InstantsTrie::getChild(uint32_t node, char c) const {
+	const std::vector<std::pair<char, uint32_t> >& children = m_nodes[node].children;
+	std::vector<std::pair<char, uint32_t> >::const_iterator it = std::lower_bound(children.begin(), children.end(), std::make_pair(c, (uint32_t)0));
+	if (it == children.end() || it->first != c) {
+		return -1;
+	}
+	return it->second;
+}
+
 uint32_t Spells::getInstantSpellCount(const Player* player) {
 	uint32_t count = 0;
 	for (InstantsMap::iterator it = instants.begin(); it != instants.end(); ++it) {
@@ -36,6 +36,25 @@
 	typedef std::map<uint32_t, RuneSpell*> RunesMap;
 	typedef std::map<std::string, InstantSpell*> InstantsMap;
 
+	// prefix tree over the lowercased words of all instant spells, built once
+	// after (re)loading, so finding the spell of a line walks it only once
+	class InstantsTrie {
+		public:
+			void build(const InstantsMap& instants);
+			InstantSpell* getLongestPrefix(const std::string& words) const;
+
+		protected:
+			struct Node {
+				Node(): spell(NULL) {}
+
+				InstantSpell* spell;
+				std::vector<std::pair<char, uint32_t> > children; // sorted by character
+			};
+
+			int32_t getChild(uint32_t node, char c) const;
+			std::vector<Node> m_nodes;
+	};
+
 	class Spells : public BaseEvents {
 		public:
 			Spells();
@@ -73,6 +92,9 @@
 			RunesMap runes;
 			InstantsMap instants;
 
+			InstantsTrie instantsTrie;
+			bool instantsChanged;
+
 			friend class CombatSpell;
 	};
 
@@ -27,6 +27,8 @@
 #include "outputmessage.h"
 
 #include "configmanager.h"
+#include "scheduler.h"
+#include "metrics.h"
 #include "game.h"
 
 extern ConfigManager g_config;
@@ -94,7 +96,82 @@ void ProtocolStatus::deleteProtocolTask() {
 	Protocol::deleteProtocolTask();
 }
 
-std::string Status::getStatusString(bool sendPlayers) const {
+StatusCache_ptr Status::getCache() {
+	StatusCache_ptr cache;
+	{
+		boost::mutex::scoped_lock lockClass(m_cacheLock);
+		cache = m_cache;
+	}
+
+	if (isStale(cache)) {
+		refresh();
+	}
+
+	return cache;
+}
+
+bool Status::isStale(const StatusCache_ptr& cache) const {
+	return !cache || OTSYS_TIME() - cache->built >= g_config.getNumber(ConfigManager::STATUS_CACHE_INTERVAL)
+		|| cache->playersOnline != Metrics::getInstance()->get(METRIC_PLAYERS_ONLINE);
+}
+
+void Status::refresh() {
+	if (m_rebuilding.exchange(true)) {
+		return; // already queued
+	}
+
+	Dispatcher::getInstance().addTask(createTask(boost::bind(&Status::rebuild, this)));
+}
+
+void Status::rebuild() {
+	boost::shared_ptr<StatusCache> cache(new StatusCache);
+	cache->built = OTSYS_TIME();
+	cache->playersOnline = g_game.getPlayersOnline();
+	cache->playersRecord = g_game.getPlayersRecord();
+	cache->monstersOnline = g_game.getMonstersOnline();
+	cache->npcsOnline = g_game.getNpcsOnline();
+
+	uint32_t mapWidth, mapHeight;
+	g_game.getMapDimensions(mapWidth, mapHeight);
+	cache->mapWidth = mapWidth;
+	cache->mapHeight = mapHeight;
+
+	std::stringstream ss;
+	cache->players.reserve(cache->playersOnline);
+	for (AutoList<Player>::iterator it = Player::autoList.begin(); it != Player::autoList.end(); ++it) {
+		if (it->second->isRemoved() || it->second->isGhost()) {
+			continue;
+		}
+
+		if (!cache->players.empty()) {
+			ss << ";";
+		}
+
+		ss << it->second->getName() << "," << it->second->getVocationId() << "," << it->second->getLevel();
+		cache->players.push_back(std::make_pair(it->second->getName(), it->second->getLevel()));
+		cache->names.insert(asLowerCaseString(it->second->getName()));
+	}
+
+	cache->xml = buildStatusString(*cache, false, "");
+	cache->xmlPlayers = buildStatusString(*cache, true, ss.str());
+	{
+		boost::mutex::scoped_lock lockClass(m_cacheLock);
+		m_cache = cache;
+	}
+
+	m_rebuilding = false;
+}
+
+std::string Status::getStatusString(bool sendPlayers) {
+	StatusCache_ptr cache = getCache();
+	if (!cache) {
+		return "";
+	}
+
+	return sendPlayers ? cache->xmlPlayers : cache->xml;
+}
+
+std::string Status::buildStatusString(const StatusCache& cache, bool sendPlayers, const std::string& players) const {
 	char buffer[90];
 	xmlDocPtr doc;
 	xmlNodePtr p, root;
@@ -106,7 +183,7 @@ std::string Status::getStatusString(bool sendPlayers) const {
 	xmlSetProp(root, (const xmlChar*)"version", (const xmlChar*)"1.0");
 
 	p = xmlNewNode(NULL,(const xmlChar*)"serverinfo");
-	sprintf(buffer, "%u", (uint32_t)getUptime());
+	sprintf(buffer, "%u", (uint32_t)((cache.built - m_start) / 1000));
 	xmlSetProp(p, (const xmlChar*)"uptime", (const xmlChar*)buffer);
 	xmlSetProp(p, (const xmlChar*)"ip", (const xmlChar*)g_config.getString(ConfigManager::IP).c_str());
 	xmlSetProp(p, (const xmlChar*)"servername", (const xmlChar*)g_config.getString(ConfigManager::SERVER_NAME).c_str());
@@ -125,36 +202,25 @@ std::string Status::getStatusString(bool sendPlayers) const {
 	xmlAddChild(root, p);
 
 	p = xmlNewNode(NULL,(const xmlChar*)"players");
-	sprintf(buffer, "%d", g_game.getPlayersOnline());
+	sprintf(buffer, "%u", cache.playersOnline);
 	xmlSetProp(p, (const xmlChar*)"online", (const xmlChar*)buffer);
 	sprintf(buffer, "%d", g_config.getNumber(ConfigManager::MAX_PLAYERS));
 	xmlSetProp(p, (const xmlChar*)"max", (const xmlChar*)buffer);
-	sprintf(buffer, "%d", g_game.getPlayersRecord());
+	sprintf(buffer, "%u", cache.playersRecord);
 	xmlSetProp(p, (const xmlChar*)"peak", (const xmlChar*)buffer);
 	if (sendPlayers) {
-		std::stringstream ss;
-		for (AutoList<Player>::iterator it = Player::autoList.begin(); it != Player::autoList.end(); ++it) {
-			if (it->second->isRemoved() || it->second->isGhost()) {
-				continue;
-			}
-
-			if (!ss.str().empty()) {
-				ss << ";";
-			}
-			ss << it->second->getName() << "," << it->second->getVocationId() << "," << it->second->getLevel();
-		}
-		xmlNodeSetContent(p, (const xmlChar*)ss.str().c_str());
+		xmlNodeSetContent(p, (const xmlChar*)players.c_str());
 	}
 
 	xmlAddChild(root, p);
 
 	p = xmlNewNode(NULL,(const xmlChar*)"monsters");
-	sprintf(buffer, "%d", g_game.getMonstersOnline());
+	sprintf(buffer, "%u", cache.monstersOnline);
 	xmlSetProp(p, (const xmlChar*)"total", (const xmlChar*)buffer);
 	xmlAddChild(root, p);
 
 	p = xmlNewNode(NULL,(const xmlChar*)"npcs");
-	sprintf(buffer, "%d", g_game.getNpcsOnline());
+	sprintf(buffer, "%u", cache.npcsOnline);
 	xmlSetProp(p, (const xmlChar*)"total", (const xmlChar*)buffer);
 	xmlAddChild(root, p);
 
@@ -162,17 +228,31 @@ std::string Status::getStatusString(bool sendPlayers) const {
 	xmlSetProp(p, (const xmlChar*)"name", (const xmlChar*)g_config.getString(ConfigManager::MAP_NAME).c_str());
 	xmlSetProp(p, (const xmlChar*)"author", (const xmlChar*)g_config.getString(ConfigManager::MAP_AUTHOR).c_str());
 
-	uint32_t mapWidth, mapHeight;
-	g_game.getMapDimensions(mapWidth, mapHeight);
-	sprintf(buffer, "%u", mapWidth);
+	sprintf(buffer, "%u", cache.mapWidth);
 	xmlSetProp(p, (const xmlChar*)"width", (const xmlChar*)buffer);
-	sprintf(buffer, "%u", mapHeight);
+	sprintf(buffer, "%u", cache.mapHeight);
 
 	xmlSetProp(p, (const xmlChar*)"height", (const xmlChar*)buffer);
 	xmlAddChild(root, p);
 
 	xmlNewTextChild(root, NULL, (const xmlChar*)"motd", (const xmlChar*)g_config.getString(ConfigManager::MOTD).c_str());
 
+	const Dispatcher& dispatcher = Dispatcher::getInstance();
+	p = xmlNewNode(NULL,(const xmlChar*)"dispatcher");
+	sprintf(buffer, "%u", dispatcher.getTaskCount());
+	xmlSetProp(p, (const xmlChar*)"queue", (const xmlChar*)buffer);
+	sprintf(buffer, "%u", Scheduler::getInstance().getEventCount());
+	xmlSetProp(p, (const xmlChar*)"events", (const xmlChar*)buffer);
+	sprintf(buffer, "%u", (uint32_t)dispatcher.getTaskDuration().getPercentile(0.5));
+	xmlSetProp(p, (const xmlChar*)"p50", (const xmlChar*)buffer);
+	sprintf(buffer, "%u", (uint32_t)dispatcher.getTaskDuration().getPercentile(0.99));
+	xmlSetProp(p, (const xmlChar*)"p99", (const xmlChar*)buffer);
+	sprintf(buffer, "%u", (uint32_t)dispatcher.getQueueLatency().getPercentile(0.5));
+	xmlSetProp(p, (const xmlChar*)"latencyp50", (const xmlChar*)buffer);
+	sprintf(buffer, "%u", (uint32_t)dispatcher.getQueueLatency().getPercentile(0.99));
+	xmlSetProp(p, (const xmlChar*)"latencyp99", (const xmlChar*)buffer);
+	xmlAddChild(root, p);
+
 	xmlChar* s = NULL;
 	int32_t len = 0;
 	xmlDocDumpMemory(doc, (xmlChar**)&s, &len);
@@ -187,7 +267,12 @@ std::string Status::getStatusString(bool sendPlayers) const {
 	return xml;
 }
 
-void Status::getInfo(uint32_t requestedInfo, OutputMessage_ptr output, NetworkMessage& msg) const {
+void Status::getInfo(uint32_t requestedInfo, OutputMessage_ptr output, NetworkMessage& msg) {
+	StatusCache_ptr cache = getCache();
+	if (!cache) {
+		return;
+	}
+
 	if (requestedInfo & REQUEST_BASIC_SERVER_INFO) {
 		output->put<char>(0x10);
 		output->putString(g_config.getString(ConfigManager::SERVER_NAME).c_str());
@@ -217,33 +302,23 @@ void Status::getInfo(uint32_t requestedInfo, OutputMessage_ptr output, NetworkMe
 
 	if (requestedInfo & REQUEST_PLAYERS_INFO) {
 		output->put<char>(0x20);
-		output->put<uint32_t>(g_game.getPlayersOnline());
+		output->put<uint32_t>(cache->playersOnline);
 		output->put<uint32_t>(g_config.getNumber(ConfigManager::MAX_PLAYERS));
-		output->put<uint32_t>(g_game.getPlayersRecord());
+		output->put<uint32_t>(cache->playersRecord);
 	}
 
 	if (requestedInfo & REQUEST_SERVER_MAP_INFO) {
 		output->put<char>(0x30);
 		output->putString(g_config.getString(ConfigManager::MAP_NAME).c_str());
 		output->putString(g_config.getString(ConfigManager::MAP_AUTHOR).c_str());
-
-		uint32_t mapWidth, mapHeight;
-		g_game.getMapDimensions(mapWidth, mapHeight);
-		output->put<uint16_t>(mapWidth);
-		output->put<uint16_t>(mapHeight);
+		output->put<uint16_t>(cache->mapWidth);
+		output->put<uint16_t>(cache->mapHeight);
 	}
 
 	if (requestedInfo & REQUEST_EXT_PLAYERS_INFO) {
 		output->put<char>(0x21);
-		std::list<std::pair<std::string, uint32_t> > players;
-		for (AutoList<Player>::iterator it = Player::autoList.begin(); it != Player::autoList.end(); ++it) {
-			if (!it->second->isRemoved() && !it->second->isGhost()) {
-				players.push_back(std::make_pair(it->second->getName(), it->second->getLevel()));
-			}
-		}
-
-		output->put<uint32_t>(players.size());
-		for (std::list<std::pair<std::string, uint32_t> >::iterator it = players.begin(); it != players.end(); ++it) {
+		output->put<uint32_t>(cache->players.size());
+		for (StatusPlayerList::const_iterator it = cache->players.begin(); it != cache->players.end(); ++it) {
 			output->putString(it->first);
 			output->put<uint32_t>(it->second);
 		}
@@ -251,14 +326,25 @@ void Status::getInfo(uint32_t requestedInfo, OutputMessage_ptr output, NetworkMe
 
 	if (requestedInfo & REQUEST_PLAYER_STATUS_INFO) {
 		output->put<char>(0x22);
-		const std::string name = msg.getString();
-
-		Player* p = NULL;
-		if (g_game.getPlayerByNameWildcard(name, p) == RET_NOERROR && !p->isGhost()) {
-			output->put<char>(0x01);
-		} else {
-			output->put<char>(0x00);
+		std::string name = asLowerCaseString(msg.getString());
+
+		bool online = false;
+		if (!name.empty()) {
+			char tmp = *name.rbegin();
+			if (tmp != '~' && tmp != '*') {
+				online = cache->names.find(name) != cache->names.end();
+			} else {
+				// wildcard has to match exactly one player, like Game::getPlayerByNameWildcard
+				name.erase(name.length() - 1);
+				std::set<std::string>::const_iterator it = cache->names.lower_bound(name);
+				if (it != cache->names.end() && !it->compare(0, name.length(), name)) {
+					++it;
+					online = it == cache->names.end() || it->compare(0, name.length(), name);
+				}
+			}
 		}
+
+		output->put<char>(online ? 0x01 : 0x00);
 	}
 
 	if (requestedInfo & REQUEST_SERVER_SOFTWARE_INFO) {
@@ -267,4 +353,16 @@ void Status::getInfo(uint32_t requestedInfo, OutputMessage_ptr output, NetworkMe
 		output->putString(SOFTWARE_VERSION);
 		output->putString(SOFTWARE_PROTOCOL);
 	}
+
+	if (requestedInfo & REQUEST_SERVER_PERFORMANCE_INFO) {
+		// timings are in microseconds
+		const Dispatcher& dispatcher = Dispatcher::getInstance();
+		output->put<char>(0x24);
+		output->put<uint32_t>(dispatcher.getTaskCount());
+		output->put<uint32_t>(Scheduler::getInstance().getEventCount());
+		output->put<uint32_t>(dispatcher.getTaskDuration().getPercentile(0.5));
+		output->put<uint32_t>(dispatcher.getTaskDuration().getPercentile(0.99));
+		output->put<uint32_t>(dispatcher.getQueueLatency().getPercentile(0.5));
+		output->put<uint32_t>(dispatcher.getQueueLatency().getPercentile(0.99));
+	}
 }
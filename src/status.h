@@ -21,6 +21,8 @@
 	#include "otsystem.h"
 	#include "protocol.h"
 
+	#include <boost/atomic.hpp>
+
 	enum RequestedInfo_t {
 		REQUEST_BASIC_SERVER_INFO = 0x01,
 		REQUEST_SERVER_OWNER_INFO = 0x02,
@@ -29,7 +31,8 @@
 		REQUEST_SERVER_MAP_INFO = 0x10,
 		REQUEST_EXT_PLAYERS_INFO = 0x20,
 		REQUEST_PLAYER_STATUS_INFO = 0x40,
-		REQUEST_SERVER_SOFTWARE_INFO = 0x80
+		REQUEST_SERVER_SOFTWARE_INFO = 0x80,
+		REQUEST_SERVER_PERFORMANCE_INFO = 0x100
 	};
 
 	typedef std::map<uint32_t, int64_t> IpConnectMap;
@@ -66,6 +69,18 @@
 			virtual void deleteProtocolTask();
 	};
 
+	typedef std::vector<std::pair<std::string, uint32_t> > StatusPlayerList;
+	struct StatusCache {
+		int64_t built;
+		uint32_t playersOnline, playersRecord, monstersOnline, npcsOnline;
+		uint16_t mapWidth, mapHeight;
+
+		std::string xml, xmlPlayers;
+		StatusPlayerList players;
+		std::set<std::string> names;
+	};
+	typedef boost::shared_ptr<const StatusCache> StatusCache_ptr;
+
 	class Status {
 		public:
 			virtual ~Status() {}
@@ -74,8 +89,13 @@
 				return &status;
 			}
 
-			std::string getStatusString(bool sendPlayers) const;
-			void getInfo(uint32_t requestedInfo, OutputMessage_ptr output, NetworkMessage& msg) const;
+			// safe to call from any thread, answers are served from the last snapshot
+			std::string getStatusString(bool sendPlayers);
+			void getInfo(uint32_t requestedInfo, OutputMessage_ptr output, NetworkMessage& msg);
+
+			// queues a rebuild when the snapshot is stale, rebuild itself runs on the dispatcher thread
+			void refresh();
+			void rebuild();
 
 			uint32_t getUptime() const {
 				return (OTSYS_TIME() - m_start) / 1000;
@@ -85,11 +105,19 @@
 			}
 
 		protected:
-			Status() {
+			Status(): m_rebuilding(false) {
 				m_start = OTSYS_TIME();
 			}
 
+			StatusCache_ptr getCache();
+			bool isStale(const StatusCache_ptr& cache) const;
+			std::string buildStatusString(const StatusCache& cache, bool sendPlayers, const std::string& players) const;
+
 		private:
 			int64_t m_start;
+
+			boost::mutex m_cacheLock;
+			StatusCache_ptr m_cache;
+			boost::atomic<bool> m_rebuilding;
 	};
 #endif
@@ -57,6 +57,7 @@ TalkActions::TalkActions():
 	m_interface("TalkAction Interface") {
 		m_interface.initState();
 		defaultTalkAction = NULL;
+		talksChanged = true;
 	}
 
 TalkActions::~TalkActions() {
@@ -69,6 +70,7 @@ void TalkActions::clear() {
 	}
 
 	talksMap.clear();
+	talksChanged = true;
 	m_interface.reInitState();
 
 	delete defaultTalkAction;
@@ -118,6 +120,7 @@ bool TalkActions::registerEvent(Event* event, xmlNodePtr p, bool override) {
 			}
 		}
 		talksMap[(*it)] = new TalkAction(talkAction);
+		talksChanged = true;
 	}
 
 	delete talkAction;
@@ -145,13 +148,31 @@ bool TalkActions::onPlayerSay(Creature* creature, uint16_t channelId, const std:
 		}
 	}
 
-	TalkAction* talkAction = NULL;
-	for (TalkActionsMap::iterator it = talksMap.begin(); it != talksMap.end(); ++it) {
-		if (it->first == cmd[it->second->getFilter()] || (!it->second->isSensitive() &&
-			!strcasecmp(it->first.c_str(), cmd[it->second->getFilter()].c_str()))) {
-			talkAction = it->second;
-			break;
+	if (talksChanged) {
+		buildIndex();
+	}
+
+	// several filters may match, the first one in map order wins as before
+	TalkActionsMap::iterator talk = talksMap.end();
+	for (int32_t i = TALKFILTER_QUOTATION; i < TALKFILTER_LAST; ++i) {
+		TalkActionsIndex::iterator it = talksIndex[i].find(cmd[i]);
+		if (it != talksIndex[i].end() && (talk == talksMap.end() || it->second->first < talk->first)) {
+			talk = it->second;
 		}
+
+		if (caselessTalksIndex[i].empty()) {
+			continue;
+		}
+
+		it = caselessTalksIndex[i].find(asLowerCaseString(cmd[i]));
+		if (it != caselessTalksIndex[i].end() && (talk == talksMap.end() || it->second->first < talk->first)) {
+			talk = it->second;
+		}
+	}
+
+	TalkAction* talkAction = NULL;
+	if (talk != talksMap.end()) {
+		talkAction = talk->second;
 	}
 
 	if (!talkAction && defaultTalkAction) {
@@ -189,6 +210,23 @@ bool TalkActions::onPlayerSay(Creature* creature, uint16_t channelId, const std:
 	return false;
 }
 
+void TalkActions::buildIndex() {
+	for (int32_t i = TALKFILTER_QUOTATION; i < TALKFILTER_LAST; ++i) {
+		talksIndex[i].clear();
+		caselessTalksIndex[i].clear();
+	}
+
+	for (TalkActionsMap::iterator it = talksMap.begin(); it != talksMap.end(); ++it) {
+		TalkActionFilter filter = it->second->getFilter();
+		talksIndex[filter][it->first] = it;
+		if (!it->second->isSensitive()) {
+			// keeps the first of the words differing only in case
+			caselessTalksIndex[filter].insert(std::make_pair(asLowerCaseString(it->first), it));
+		}
+	}
+	talksChanged = false;
+}
+
 TalkAction::TalkAction(LuaInterface* _interface):
 	Event(_interface) {
 		m_function = NULL;
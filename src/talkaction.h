@@ -19,6 +19,7 @@
 	#define __TALKACTION__
 
 	#include "otsystem.h"
+	#include <boost/tr1/unordered_map.hpp>
 
 	#include "enums.h"
 	#include "player.h"
@@ -36,6 +37,7 @@
 
 	class TalkAction;
 	typedef std::map<std::string, TalkAction*> TalkActionsMap;
+	typedef std::tr1::unordered_map<std::string, TalkActionsMap::iterator> TalkActionsIndex;
 
 	class TalkActions : public BaseEvents {
 		public:
@@ -55,6 +57,13 @@
 			TalkAction* defaultTalkAction;
 			TalkActionsMap talksMap;
 
+			// words of every filter, as registered and lowercased for the case
+			// insensitive ones; rebuilt on the first line said after a (re)load
+			TalkActionsIndex talksIndex[TALKFILTER_LAST], caselessTalksIndex[TALKFILTER_LAST];
+			bool talksChanged;
+
+			void buildIndex();
+
 			virtual std::string getScriptBaseName() const {
 				return "talkactions";
 			}
@@ -32,12 +32,23 @@
 #include "movement.h"
 
 #include "game.h"
+#include "spawn.h"
 #include "configmanager.h"
 
 extern ConfigManager g_config;
 extern Game g_game;
 extern MoveEvents* g_moveEvents;
 
+#ifdef __OTSERV_ALLOCATOR__
+	// house tiles are bigger than a slot and keep using the global pools
+	DEFINE_SLAB_ALLOCATOR(DynamicTile, "dynamic_tile", sizeof(DynamicTile))
+	DEFINE_SLAB_ALLOCATOR(StaticTile, "static_tile", sizeof(StaticTile))
+#endif
+
+// tiles holding a description, reused round robin
+static std::vector<const Tile*> descriptionCache(TILE_DESCRIPTION_CACHE, (const Tile*)NULL);
+static uint32_t descriptionCacheNext = 0;
+
 StaticTile reallyNullTile(0xFFFF, 0xFFFF, 0xFFFF);
 Tile& Tile::nullTile = reallyNullTile;
 
@@ -73,6 +84,10 @@ bool Tile::hasProperty(Item* exclude, enum ITEMPROPERTY prop) const {
 	return false;
 }
 
+void Tile::syncFlags() {
+	qt_node->getFloor(pos.z)->flags[pos.x & FLOOR_MASK][pos.y & FLOOR_MASK] = m_flags;
+}
+
 HouseTile* Tile::getHouseTile() {
 	if (isHouseTile()) {
 		return static_cast<HouseTile*>(this);
@@ -431,6 +446,9 @@ void Tile::moveCreature(Creature* actor, Creature* creature, Cylinder* toCylinde
 	if (qt_node != newTile->qt_node) {
 		qt_node->removeCreature(creature);
 		newTile->qt_node->addCreature(creature);
+		if (creature->getPlayer()) {
+			Spawns::getInstance()->onPlayerEnter(newPos);
+		}
 	}
 
 	// add the creature
@@ -862,11 +880,7 @@ void Tile::__addThing(Creature* actor, int32_t, Thing* thing) {
 		return/* RET_NOTPOSSIBLE*/;
 	}
 
-	if (g_config.getBool(ConfigManager::STORE_TRASH) && !hasFlag(TILESTATE_TRASHED)) {
-		g_game.addTrash(pos);
-		setFlag(TILESTATE_TRASHED);
-	}
-
+	markTrash(item);
 	item->setParent(this);
 	if (item->isGroundTile()) {
 		if (ground) {
@@ -999,6 +1013,10 @@ void Tile::__updateThing(Thing* thing, uint16_t itemId, uint32_t count) {
 	item->setSubType(count);
 
 	updateTileFlags(item, false);
+	if (Item::items[oldId].movable != Item::items[itemId].movable) {
+		updateTrash();
+	}
+
 	onUpdateTileItem(item, Item::items[oldId], item, Item::items[itemId]);
 }
 
@@ -1072,6 +1090,7 @@ void Tile::__replaceThing(uint32_t index, Thing* thing) {
 
 	updateTileFlags(item, false);
 	if (oldItem) {
+		updateTrash();
 		onUpdateTileItem(oldItem, Item::items[oldItem->getID()], item, Item::items[item->getID()]);
 		oldItem->setParent(NULL);
 		return/* RET_NOERROR*/;
@@ -1167,6 +1186,10 @@ void Tile::__removeThing(Thing* thing, uint32_t count) {
 			items->erase(it);
 
 			--thingCount;
+			if (item->isMovable() && !item->isLoadedFromMap()) {
+				updateTrash();
+			}
+
 			onRemoveTileItem(list, oldStackposVector, item);
 			return/* RET_NOERROR*/;
 		}
@@ -1201,6 +1224,10 @@ void Tile::__removeThing(Thing* thing, uint32_t count) {
 
 				--items->downItemCount;
 				--thingCount;
+				if (item->isMovable() && !item->isLoadedFromMap()) {
+					updateTrash();
+				}
+
 				onRemoveTileItem(list, oldStackposVector, item);
 			}
 			return/* RET_NOERROR*/;
@@ -1487,7 +1514,149 @@ void Tile::__internalAddThing(uint32_t, Thing* thing) {
 	updateTileFlags(item, false);
 }
 
+void Tile::markTrash(const Item* item) {
+	if (hasFlag(TILESTATE_TRASHED) || hasFlag(TILESTATE_HOUSE) || !item->isMovable() || item->isLoadedFromMap()) {
+		return;
+	}
+
+	setFlag(TILESTATE_TRASHED);
+	g_game.addTrash(this);
+}
+
+void Tile::updateTrash() {
+	bool trashed = false;
+	if (!hasFlag(TILESTATE_HOUSE)) {
+		if (const TileItemVector* items = getItemList()) {
+			for (ItemVector::const_iterator it = items->begin(); it != items->end(); ++it) {
+				if ((*it)->isMovable() && !(*it)->isLoadedFromMap()) {
+					trashed = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (trashed == hasFlag(TILESTATE_TRASHED)) {
+		return;
+	}
+
+	if (trashed) {
+		setFlag(TILESTATE_TRASHED);
+		g_game.addTrash(this);
+	} else {
+		resetFlag(TILESTATE_TRASHED);
+		g_game.removeTrash(this);
+	}
+}
+
+void Tile::resetDownItems(const ItemVector& list, ItemVector& removed) {
+	TileItemVector* items = getItemList();
+	if (!items) {
+		if (list.empty()) {
+			return;
+		}
+
+		items = makeItemList();
+	}
+
+	removed.assign(items->getBeginDownItem(), items->getEndDownItem());
+	items->items.erase(items->getBeginDownItem(), items->getEndDownItem());
+	items->items.insert(items->items.begin(), list.begin(), list.end());
+
+	thingCount = thingCount - removed.size() + list.size();
+	items->downItemCount = list.size();
+	for (ItemVector::iterator it = removed.begin(); it != removed.end(); ++it) {
+		(*it)->setParent(NULL);
+		updateTileFlags(*it, true);
+	}
+
+	for (ItemVector::const_iterator it = list.begin(); it != list.end(); ++it) {
+		(*it)->setParent(this);
+	}
+
+	// removing may have cleared flags that the ground or the remaining items still set
+	if (ground) {
+		updateTileFlags(ground, false);
+	}
+
+	for (ItemVector::iterator it = items->items.begin(); it != items->items.end(); ++it) {
+		updateTileFlags(*it, false);
+	}
+
+	updateTrash();
+	onUpdateTile();
+
+	// players can't keep the removed containers open
+	const SpectatorVec& spectators = g_game.getSpectators(pos);
+	for (ItemVector::iterator it = removed.begin(); it != removed.end(); ++it) {
+		if (!(*it)->getContainer()) {
+			continue;
+		}
+
+		Player* tmpPlayer = NULL;
+		for (SpectatorVec::const_iterator sit = spectators.begin(); sit != spectators.end(); ++sit) {
+			if ((tmpPlayer = (*sit)->getPlayer())) {
+				tmpPlayer->postRemoveNotification(NULL, *it, NULL, 0, true, LINK_NEAR);
+			}
+		}
+	}
+}
+
+const TileDescription& Tile::getDescription() const {
+	if (m_description) {
+		return *m_description;
+	}
+
+	TileDescription* description = new TileDescription();
+	char top[TILE_DESCRIPTION_ITEMS * NETWORKMESSAGE_ITEM_MAXSIZE], down[TILE_DESCRIPTION_ITEMS * NETWORKMESSAGE_ITEM_MAXSIZE];
+	if (ground) {
+		description->topSize += NetworkMessage::encodeItem(ground, top);
+		++description->topCount;
+	}
+
+	uint8_t downSize = 0;
+	if (const TileItemVector* items = getItemList()) {
+		for (ItemVector::const_iterator it = items->getBeginTopItem(); it != items->getEndTopItem() && description->topCount < TILE_DESCRIPTION_ITEMS; ++it) {
+			description->topSize += NetworkMessage::encodeItem(*it, top + description->topSize);
+			++description->topCount;
+		}
+
+		for (ItemVector::const_iterator it = items->getBeginDownItem(); it != items->getEndDownItem() && description->downCount < TILE_DESCRIPTION_ITEMS; ++it) {
+			downSize += NetworkMessage::encodeItem(*it, down + downSize);
+			description->downEnd[description->downCount++] = downSize;
+		}
+	}
+
+	description->data = new char[description->topSize + downSize];
+	memcpy(description->data, top, description->topSize);
+	memcpy(description->data + description->topSize, down, downSize);
+
+	// drop the description that has been cached the longest to make room
+	description->slot = descriptionCacheNext;
+	descriptionCacheNext = (descriptionCacheNext + 1) % TILE_DESCRIPTION_CACHE;
+	if (const Tile* tile = descriptionCache[description->slot]) {
+		tile->resetDescription();
+	}
+
+	descriptionCache[description->slot] = this;
+	m_description = description;
+	return *description;
+}
+
+void Tile::resetDescription() const {
+	if (!m_description) {
+		return;
+	}
+
+	descriptionCache[m_description->slot] = NULL;
+	delete m_description;
+	m_description = NULL;
+}
+
 void Tile::updateTileFlags(Item* item, bool remove) {
+	// every change to the items of the tile passes through here
+	resetDescription();
+
 	if (!remove) {
 		if (!hasFlag(TILESTATE_FLOORCHANGE)) {
 			if (item->floorChange(CHANGE_DOWN)) {
@@ -1579,6 +1748,10 @@ void Tile::updateTileFlags(Item* item, bool remove) {
 		if (item->hasProperty(IMMOVABLENOFIELDBLOCKPATH)) {
 			setFlag(TILESTATE_IMMOVABLENOFIELDBLOCKPATH);
 		}
+
+		if (item->hasProperty(BLOCKPROJECTILE)) {
+			setFlag(TILESTATE_BLOCKPROJECTILE);
+		}
 	} else {
 		if (item->floorChange(CHANGE_DOWN)) {
 			resetFlag(TILESTATE_FLOORCHANGE);
@@ -1672,5 +1845,9 @@ void Tile::updateTileFlags(Item* item, bool remove) {
 		if (item->hasProperty(IMMOVABLENOFIELDBLOCKPATH) && !hasProperty(item, IMMOVABLENOFIELDBLOCKPATH)) {
 			resetFlag(TILESTATE_IMMOVABLENOFIELDBLOCKPATH);
 		}
+
+		if (item->hasProperty(BLOCKPROJECTILE) && !hasProperty(item, BLOCKPROJECTILE)) {
+			resetFlag(TILESTATE_BLOCKPROJECTILE);
+		}
 	}
 }
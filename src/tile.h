@@ -22,6 +22,7 @@
 
 	#include "cylinder.h"
 	#include "item.h"
+	#include "networkmessage.h"
 
 	class Teleport;
 	class TrashHolder;
@@ -72,7 +73,8 @@
 		TILESTATE_IMMOVABLEBLOCKPATH = 1 << 26,
 		TILESTATE_IMMOVABLENOFIELDBLOCKPATH = 1 << 27,
 		TILESTATE_NOFIELDBLOCKPATH = 1 << 28,
-		TILESTATE_DYNAMIC_TILE = 1 << 29
+		TILESTATE_DYNAMIC_TILE = 1 << 29,
+		TILESTATE_BLOCKPROJECTILE = 1 << 30
 	};
 
 	enum ZoneType_t {
@@ -83,6 +85,33 @@
 		ZONE_OPEN
 	};
 
+	// the client is sent at most this many things per tile
+	#define TILE_DESCRIPTION_ITEMS 10
+
+	// at most this many tiles keep a description, the oldest one is dropped first
+	#define TILE_DESCRIPTION_CACHE 65536
+
+	// client encoding of the items on a tile, built when the tile is described
+	// and shared by every player until one of its items changes
+	struct TileDescription {
+		TileDescription(): slot(0), topCount(0), topSize(0), downCount(0), data(NULL) {}
+		~TileDescription() {
+			delete[] data;
+		}
+
+		const char* getTop() const {
+			return data;
+		}
+		const char* getDown() const {
+			return data + topSize;
+		}
+
+		uint32_t slot;
+		uint8_t topCount, topSize, downCount;
+		uint8_t downEnd[TILE_DESCRIPTION_ITEMS]; // size of down after each item
+		char* data; // top followed by down, sized to the encoded bytes
+	};
+
 	class TileItemVector {
 		public:
 			TileItemVector():
@@ -245,11 +274,20 @@
 			}
 			void setFlag(tileflags_t flag) {
 				m_flags |= (uint32_t)flag;
+				if (qt_node) {
+					syncFlags();
+				}
 			}
 			void resetFlag(tileflags_t flag) {
 				m_flags &= ~(uint32_t)flag;
+				if (qt_node) {
+					syncFlags();
+				}
 			}
 
+			// copies the flags into the floor arrays once the tile is on the map
+			void syncFlags();
+
 			bool positionChange() const {
 				return hasFlag(TILESTATE_TELEPORT);
 			}
@@ -387,12 +425,22 @@
 			virtual void __internalAddThing(uint32_t index, Thing* thing);
 			void onUpdateTile();
 
+			// swaps all down items at once, without the per-item checks and client updates
+			void resetDownItems(const ItemVector& list, ItemVector& removed);
+
+			// ground, top and down items as sent to the client, creatures are not included
+			const TileDescription& getDescription() const;
+
 		private:
 			void onAddTileItem(Item* item);
 			void onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newItem, const ItemType& newType);
 			void onRemoveTileItem(const SpectatorVec& list, std::vector<uint32_t>& oldStackPosVector, Item* item);
 
 			void updateTileFlags(Item* item, bool remove);
+			void resetDescription() const;
+
+			void markTrash(const Item* item);
+			void updateTrash();
 
 		protected:
 			bool isDynamic() const {
@@ -406,6 +454,8 @@
 		protected:
 			Position pos;
 			uint32_t m_flags, thingCount;
+
+			mutable TileDescription* m_description;
 	};
 
 	// Used for walkable tiles, where there is high likeliness of
@@ -415,6 +465,10 @@
 		TileItemVector items;
 		CreatureVector creatures;
 		public:
+			#ifdef __OTSERV_ALLOCATOR__
+				DECLARE_SLAB_ALLOCATOR()
+			#endif
+
 			DynamicTile(uint16_t x, uint16_t y, uint16_t z);
 			virtual ~DynamicTile();
 
@@ -445,6 +499,10 @@
 		TileItemVector* items;
 		CreatureVector*	creatures;
 		public:
+			#ifdef __OTSERV_ALLOCATOR__
+				DECLARE_SLAB_ALLOCATOR()
+			#endif
+
 			StaticTile(uint16_t x, uint16_t y, uint16_t z);
 			virtual ~StaticTile();
 
@@ -469,9 +527,11 @@
 			}
 	};
 
-	inline Tile::Tile(uint16_t x, uint16_t y, uint16_t z):qt_node(NULL), ground(NULL), pos(x, y, z), m_flags(0), thingCount(0) {}
+	inline Tile::Tile(uint16_t x, uint16_t y, uint16_t z):qt_node(NULL), ground(NULL), pos(x, y, z), m_flags(0), thingCount(0), m_description(NULL) {}
 
-	inline Tile::~Tile() {}
+	inline Tile::~Tile() {
+		resetDescription();
+	}
 
 	inline CreatureVector* Tile::getCreatures() {
 		if (isDynamic()) {